@@ -17,16 +17,33 @@
 #include "ofxCortex/utils/PolylineUtils.h"
 #include "ofxCortex/utils/ShaderUtils.h"
 #include "ofxCortex/utils/GeometryUtils.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+#include "ofxCortex/utils/HashUtils.h"
+#include "ofxCortex/utils/Triangulator.h"
 
 #include "ofxCortex/spatial/Proximity.h"
 #include "ofxCortex/spatial/QuadTree.h"
 #include "ofxCortex/spatial/SpatialGrid.h"
+#include "ofxCortex/spatial/EdgeTable.h"
+#include "ofxCortex/spatial/MeshBVH.h"
+#include "ofxCortex/spatial/SegmentBVH.h"
+#include "ofxCortex/spatial/Delaunay.h"
 
 #include "ofxCortex/graphics/Line.h"
+#include "ofxCortex/graphics/OffsetShape.h"
+#include "ofxCortex/graphics/MeasuredPolyline.h"
+#include "ofxCortex/graphics/PolylineMorph.h"
+#include "ofxCortex/graphics/LineMesh.h"
+#include "ofxCortex/graphics/LineBatch.h"
+#include "ofxCortex/graphics/PathOptimizer.h"
+#include "ofxCortex/graphics/DistanceField.h"
+#include "ofxCortex/graphics/IsoContours.h"
 #include "ofxCortex/graphics/Typography.h"
 
 #include "ofxCortex/generators/Waveform.h"
 #include "ofxCortex/generators/Noise.h"
 #include "ofxCortex/generators/Sampling.h"
+#include "ofxCortex/generators/BlueNoiseTiles.h"
+#include "ofxCortex/generators/Hatching.h"
 
 #include "ofxCortex/types/AllTypes.h"
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <fstream>
+#include <cstring>
+
+#include "ofRectangle.h"
+#include "ofUtils.h"
+#include "ofLog.h"
+#include "ofxCortex/generators/Sampling.h"
+
+namespace ofxCortex { namespace core { namespace generators {
+
+// Precomputed blue-noise tiles that can be laid out over an unbounded plane.
+// Every tile edge carries one of `numColors` colors; tiles sharing an edge color
+// share the exact same points along it, and every corner shares one corner set,
+// so any arrangement is seamless. Tiles are picked from an integer hash of the
+// grid position, so the points of any rectangle come out in O(points) with no
+// rejection sampling at runtime. Generate once, save(), then load() in the app.
+class BlueNoiseTiles {
+public:
+  BlueNoiseTiles() {};
+  
+  // K colors produce K^4 tiles. Generation is slow-ish (it runs the Poisson disc
+  // sampler K^4 + 2K + 1 times) and meant to be done offline.
+  void generate(float tileSize, float radius, int numColors = 2, int numSamplesBeforeRejection = 32)
+  {
+    radius = MAX(radius, std::numeric_limits<float>::epsilon());
+    if (tileSize < radius * 8.0f)
+    {
+      ofLogWarning("BlueNoiseTiles::generate") << "Tile size should be at least 8 times the radius, using " << radius * 8.0f;
+      tileSize = radius * 8.0f;
+    }
+    
+    this->tileSize = tileSize;
+    this->radius = radius;
+    this->numColors = CLAMP(numColors, 1, 16);
+    
+    const float T = tileSize;
+    const float edge = radius;
+    const float corner = radius * 2.0f;
+    const int K = this->numColors;
+    auto anywhere = [](const glm::vec2 &) { return true; };
+    
+    auto translated = [](const std::vector<glm::vec2> & points, const glm::vec2 & offset) {
+      std::vector<glm::vec2> result(points.size());
+      for (size_t i = 0; i < points.size(); i++) result[i] = points[i] + offset;
+      return result;
+    };
+    
+    auto append = [](std::vector<glm::vec2> & target, const std::vector<glm::vec2> & points) {
+      target.insert(target.end(), points.begin(), points.end());
+    };
+    
+    // One corner set shared by every tile corner, centered on the corner itself
+    const std::vector<glm::vec2> corners = PoissonDisc::sampleInside(radius, ofRectangle(-corner, -corner, corner * 2.0f, corner * 2.0f), anywhere, numSamplesBeforeRejection);
+    
+    std::vector<glm::vec2> cornerConstraints;
+    for (int y = 0; y < 2; y++)
+      for (int x = 0; x < 2; x++) append(cornerConstraints, translated(corners, glm::vec2(x, y) * T));
+    
+    // Edge strips between two corners: horizontal along y = 0, vertical along x = 0
+    std::vector<std::vector<glm::vec2>> horizontal(K), vertical(K);
+    for (int color = 0; color < K; color++)
+    {
+      std::vector<glm::vec2> constraints;
+      append(constraints, corners);
+      append(constraints, translated(corners, glm::vec2(T, 0)));
+      horizontal[color] = PoissonDisc::sampleInside(radius, ofRectangle(corner, -edge, T - corner * 2.0f, edge * 2.0f), anywhere, numSamplesBeforeRejection, constraints);
+      
+      constraints.clear();
+      append(constraints, corners);
+      append(constraints, translated(corners, glm::vec2(0, T)));
+      vertical[color] = PoissonDisc::sampleInside(radius, ofRectangle(-edge, corner, edge * 2.0f, T - corner * 2.0f), anywhere, numSamplesBeforeRejection, constraints);
+    }
+    
+    points.clear();
+    offsets.assign(1, 0);
+    
+    for (int north = 0; north < K; north++)
+    for (int east = 0; east < K; east++)
+    for (int south = 0; south < K; south++)
+    for (int west = 0; west < K; west++)
+    {
+      std::vector<glm::vec2> boundary = cornerConstraints;
+      append(boundary, horizontal[north]);
+      append(boundary, translated(horizontal[south], glm::vec2(0, T)));
+      append(boundary, vertical[west]);
+      append(boundary, translated(vertical[east], glm::vec2(T, 0)));
+      
+      // Only the half of each shared set that falls inside the tile belongs to it
+      for (const auto & p : boundary)
+      {
+        if (p.x >= 0.0f && p.y >= 0.0f && p.x < T && p.y < T) points.push_back(p);
+      }
+      
+      append(points, PoissonDisc::sampleInside(radius, ofRectangle(edge, edge, T - edge * 2.0f, T - edge * 2.0f), anywhere, numSamplesBeforeRejection, boundary));
+      offsets.push_back(points.size());
+    }
+  }
+  
+  // Appends the points inside `area`. The same seed always yields the same layout.
+  void getPoints(const ofRectangle & area, std::vector<glm::vec2> & output, unsigned int seed = 0) const
+  {
+    if (empty() || area.width <= 0 || area.height <= 0) return;
+    
+    const int firstColumn = (int) floor(area.getLeft() / tileSize);
+    const int lastColumn = (int) floor(area.getRight() / tileSize);
+    const int firstRow = (int) floor(area.getTop() / tileSize);
+    const int lastRow = (int) floor(area.getBottom() / tileSize);
+    
+    for (int row = firstRow; row <= lastRow; row++)
+    {
+      for (int column = firstColumn; column <= lastColumn; column++)
+      {
+        const glm::vec2 offset(column * tileSize, row * tileSize);
+        const bool contained = area.getLeft() <= offset.x && area.getTop() <= offset.y && area.getRight() >= offset.x + tileSize && area.getBottom() >= offset.y + tileSize;
+        
+        const size_t tile = getTileIndex(column, row, seed);
+        for (size_t i = offsets[tile]; i < offsets[tile + 1]; i++)
+        {
+          const glm::vec2 p = points[i] + offset;
+          if (contained || (p.x >= area.getLeft() && p.y >= area.getTop() && p.x < area.getRight() && p.y < area.getBottom())) output.push_back(p);
+        }
+      }
+    }
+  }
+  
+  std::vector<glm::vec2> getPoints(const ofRectangle & area, unsigned int seed = 0) const
+  {
+    std::vector<glm::vec2> output;
+    getPoints(area, output, seed);
+    return output;
+  }
+  
+  // Points of a single tile, in tile coordinates [0, tileSize).
+  std::vector<glm::vec2> getTile(int north, int east, int south, int west) const
+  {
+    if (empty()) return {};
+    
+    const size_t tile = ((north * numColors + east) * numColors + south) * numColors + west;
+    return std::vector<glm::vec2>(points.begin() + offsets[tile], points.begin() + offsets[tile + 1]);
+  }
+  
+  // Binary layout, little-endian: "CXBN", version, tile size, radius, color count,
+  // tile count, per-tile point counts, then every point as two 16 bit fractions
+  // of the tile size (precision is tileSize / 65536, far below any useful radius).
+  bool save(const std::string & path) const
+  {
+    if (empty()) { ofLogWarning("BlueNoiseTiles::save") << "Nothing to save, call generate() first"; return false; }
+    
+    std::ofstream file(ofToDataPath(path, true), std::ios::binary);
+    if (!file) { ofLogWarning("BlueNoiseTiles::save") << "Can't open '" << path << "' for writing"; return false; }
+    
+    std::vector<unsigned char> bytes;
+    bytes.reserve(24 + (offsets.size() - 1) * 4 + points.size() * 4);
+    
+    auto write16 = [&](uint16_t value) { bytes.push_back(value & 0xFF); bytes.push_back(value >> 8); };
+    auto write32 = [&](uint32_t value) { for (int i = 0; i < 4; i++) bytes.push_back((value >> (i * 8)) & 0xFF); };
+    auto writeFloat = [&](float value) { uint32_t bits; memcpy(&bits, &value, 4); write32(bits); };
+    
+    for (char c : std::string("CXBN")) bytes.push_back(c);
+    write32(VERSION);
+    writeFloat(tileSize);
+    writeFloat(radius);
+    write32(numColors);
+    write32(offsets.size() - 1);
+    for (size_t tile = 0; tile + 1 < offsets.size(); tile++) write32(offsets[tile + 1] - offsets[tile]);
+    
+    for (const auto & p : points)
+    {
+      write16((uint16_t) MIN(p.x / tileSize * 65536.0f, 65535.0f));
+      write16((uint16_t) MIN(p.y / tileSize * 65536.0f, 65535.0f));
+    }
+    
+    file.write((const char *) bytes.data(), bytes.size());
+    return file.good();
+  }
+  
+  bool load(const std::string & path)
+  {
+    std::ifstream file(ofToDataPath(path, true), std::ios::binary);
+    if (!file) { ofLogWarning("BlueNoiseTiles::load") << "Can't open '" << path << "'"; return false; }
+    
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t cursor = 0;
+    
+    auto has = [&](size_t count) { return cursor + count <= bytes.size(); };
+    auto read16 = [&]() { uint16_t value = bytes[cursor] | (bytes[cursor + 1] << 8); cursor += 2; return value; };
+    auto read32 = [&]() { uint32_t value = 0; for (int i = 0; i < 4; i++) value |= (uint32_t) bytes[cursor + i] << (i * 8); cursor += 4; return value; };
+    auto readFloat = [&]() { uint32_t bits = read32(); float value; memcpy(&value, &bits, 4); return value; };
+    
+    if (!has(24) || std::string(bytes.begin(), bytes.begin() + 4) != "CXBN") { ofLogWarning("BlueNoiseTiles::load") << "'" << path << "' is not a tile set"; return false; }
+    cursor = 4;
+    
+    const uint32_t version = read32();
+    if (version != VERSION) { ofLogWarning("BlueNoiseTiles::load") << "Unsupported version " << version; return false; }
+    
+    const float loadedTileSize = readFloat();
+    const float loadedRadius = readFloat();
+    const uint32_t loadedColors = read32();
+    const uint32_t numTiles = read32();
+    
+    if (loadedColors == 0 || loadedColors > 16 || numTiles != loadedColors * loadedColors * loadedColors * loadedColors || !has(numTiles * 4))
+    {
+      ofLogWarning("BlueNoiseTiles::load") << "'" << path << "' is corrupted";
+      return false;
+    }
+    
+    std::vector<size_t> loadedOffsets(1, 0);
+    for (uint32_t tile = 0; tile < numTiles; tile++) loadedOffsets.push_back(loadedOffsets.back() + read32());
+    
+    if (!has(loadedOffsets.back() * 4)) { ofLogWarning("BlueNoiseTiles::load") << "'" << path << "' is truncated"; return false; }
+    
+    std::vector<glm::vec2> loadedPoints(loadedOffsets.back());
+    for (auto & p : loadedPoints)
+    {
+      p.x = read16() / 65536.0f * loadedTileSize;
+      p.y = read16() / 65536.0f * loadedTileSize;
+    }
+    
+    tileSize = loadedTileSize;
+    radius = loadedRadius;
+    numColors = loadedColors;
+    offsets.swap(loadedOffsets);
+    points.swap(loadedPoints);
+    
+    return true;
+  }
+  
+  float getTileSize() const { return tileSize; }
+  float getRadius() const { return radius; }
+  int getNumColors() const { return numColors; }
+  size_t getNumTiles() const { return (offsets.empty()) ? 0 : offsets.size() - 1; }
+  size_t getNumPoints() const { return points.size(); }
+  bool empty() const { return points.empty(); }
+
+protected:
+  static constexpr uint32_t VERSION = 1;
+  
+  float tileSize { 0.0f };
+  float radius { 0.0f };
+  int numColors { 0 };
+  
+  std::vector<glm::vec2> points; // every tile back to back, in tile coordinates
+  std::vector<size_t> offsets; // tile i owns points [offsets[i], offsets[i + 1])
+  
+  static uint32_t hash(int x, int y, uint32_t seed, uint32_t salt)
+  {
+    uint32_t h = (uint32_t) x * 0x8DA6B343u ^ (uint32_t) y * 0xD8163841u ^ seed * 0xCB1AB31Fu ^ salt * 0x165667B1u;
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+  }
+  
+  // The top and left edges of the tile at (column, row) carry the colors hashed from (column, row)
+  size_t getTileIndex(int column, int row, uint32_t seed) const
+  {
+    const uint32_t north = hash(column, row, seed, 0) % numColors;
+    const uint32_t south = hash(column, row + 1, seed, 0) % numColors;
+    const uint32_t west = hash(column, row, seed, 1) % numColors;
+    const uint32_t east = hash(column + 1, row, seed, 1) % numColors;
+    
+    return ((north * numColors + east) * numColors + south) * numColors + west;
+  }
+};
+
+}}}
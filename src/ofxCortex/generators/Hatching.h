@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ofPath.h"
+#include "ofPolyline.h"
+
+#include "ofxCortex/spatial/EdgeTable.h"
+
+namespace ofxCortex { namespace core { namespace generators {
+
+// Scanline hatching of closed shapes for plotters. Polygons go into an edge
+// table sorted along the hatch normal, and each hatch line only visits the
+// edges active at its height, so the cost grows with lines + edges instead of
+// lines * edges. Output is a flat segment buffer: segments[2 * i] and
+// segments[2 * i + 1] are the ends of segment i.
+class Hatching {
+public:
+  enum FillRule { FILL_EVEN_ODD, FILL_NON_ZERO };
+  
+  struct Settings {
+    float spacing { 1.0f };
+    float angle { 0.0f }; // degrees, 0 draws horizontal lines
+    float offset { 0.0f }; // shifts the lines along their normal, lines of equal settings line up across shapes
+    FillRule rule { FILL_EVEN_ODD };
+    bool crossHatch { false };
+    float crossAngle { 90.0f }; // degrees between the two passes when cross-hatching
+    bool alternate { true }; // reverse every other line so a plotter can zig-zag through them
+  };
+  
+  static void hatch(const std::vector<ofPolyline> & polygons, std::vector<glm::vec2> & segments, const Settings & settings)
+  {
+    segments.clear();
+    
+    addHatch(polygons, segments, settings, settings.angle);
+    if (settings.crossHatch) addHatch(polygons, segments, settings, settings.angle + settings.crossAngle);
+  }
+  
+  static void hatch(const ofPath & path, std::vector<glm::vec2> & segments, const Settings & settings) { hatch(path.getOutline(), segments, settings); }
+  
+  static std::vector<glm::vec2> getSegments(const std::vector<ofPolyline> & polygons, const Settings & settings)
+  {
+    std::vector<glm::vec2> segments;
+    hatch(polygons, segments, settings);
+    return segments;
+  }
+  
+  static std::vector<ofPolyline> getLines(const std::vector<ofPolyline> & polygons, const Settings & settings)
+  {
+    std::vector<glm::vec2> segments;
+    hatch(polygons, segments, settings);
+    
+    std::vector<ofPolyline> lines(segments.size() / 2);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      lines[i].addVertex(glm::vec3(segments[i * 2], 0.0f));
+      lines[i].addVertex(glm::vec3(segments[i * 2 + 1], 0.0f));
+    }
+    
+    return lines;
+  }
+
+protected:
+  // One pass of parallel lines at `angle` degrees, appended to `segments`
+  static void addHatch(const std::vector<ofPolyline> & polygons, std::vector<glm::vec2> & segments, const Settings & settings, float angle)
+  {
+    if (settings.spacing <= 0.0f) return;
+    
+    const spatial::ScanlineSweep sweep(polygons, ofDegToRad(angle));
+    if (sweep.empty()) return;
+    
+    // First row on the global grid of lines defined by spacing and offset
+    const float start = settings.offset + floor((sweep.getMinY() - settings.offset) / settings.spacing) * settings.spacing;
+    
+    sweep.sweep(start, settings.spacing, [&](int row, float y, const std::vector<spatial::ScanlineSweep::Crossing> & crossings) {
+      const size_t first = segments.size();
+      
+      if (settings.rule == FILL_EVEN_ODD)
+      {
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) addSpan(segments, sweep, crossings[i].x, crossings[i + 1].x, y);
+      }
+      else
+      {
+        int winding = 0;
+        float spanStart = 0.0f;
+        for (const auto & crossing : crossings)
+        {
+          const int previous = winding;
+          winding += crossing.winding;
+          
+          if (previous == 0 && winding != 0) spanStart = crossing.x;
+          else if (previous != 0 && winding == 0) addSpan(segments, sweep, spanStart, crossing.x, y);
+        }
+      }
+      
+      if (settings.alternate && (row % 2 != 0)) std::reverse(segments.begin() + first, segments.end());
+    });
+  }
+  
+  static void addSpan(std::vector<glm::vec2> & segments, const spatial::ScanlineSweep & sweep, float from, float to, float y)
+  {
+    if (to - from <= std::numeric_limits<float>::epsilon()) return;
+    
+    segments.push_back(sweep.fromSweep(from, y));
+    segments.push_back(sweep.fromSweep(to, y));
+  }
+};
+
+}}}
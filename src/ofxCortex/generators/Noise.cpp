@@ -229,6 +229,77 @@ double Noise::getNoise(glm::vec3 sample, float scale, float contrast, float cont
   return getNoise(sample, settings);
 }
 
+namespace {
+
+// Ken Perlin's permutation, as used by openFrameworks' simplex noise
+const uint8_t permutation[256] = {
+  151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+  190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,
+  20,125,136,171,168,68,175,74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,
+  230,220,105,92,41,55,46,245,40,244,102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,
+  169,200,196,135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,250,124,123,5,202,38,
+  147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,119,248,152,2,
+  44,154,163,70,221,153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,
+  104,218,246,97,228,251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,
+  192,214,31,181,199,106,157,184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,
+  29,24,72,243,141,128,195,78,66,215,61,156,180
+};
+
+inline int perm(int i) { return permutation[i & 255]; }
+
+// Dot product of (x, y) with one of 8 gradient directions picked by the hash
+inline float gradient(int hash, float x, float y)
+{
+  const int h = hash & 7;
+  const float u = (h < 4) ? x : y;
+  const float v = (h < 4) ? y : x;
+  return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+}
+
+inline float corner(float x, float y, int hash)
+{
+  float t = 0.5f - x * x - y * y;
+  if (t < 0.0f) return 0.0f;
+  
+  t *= t;
+  return t * t * gradient(hash, x, y);
+}
+
+}
+
+void Noise::getSignedNoise(const float * x, const float * y, size_t count, float * output)
+{
+  const float F2 = 0.366025403f; // 0.5 * (sqrt(3) - 1)
+  const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+  
+  for (size_t n = 0; n < count; n++)
+  {
+    // Skew into simplex space to find the cell, then unskew back to the cell origin
+    const float s = (x[n] + y[n]) * F2;
+    const int i = (int) floor(x[n] + s);
+    const int j = (int) floor(y[n] + s);
+    const float t = (float) (i + j) * G2;
+    
+    const float x0 = x[n] - (i - t);
+    const float y0 = y[n] - (j - t);
+    
+    // Lower or upper triangle of the cell
+    const int i1 = (x0 > y0) ? 1 : 0;
+    const int j1 = 1 - i1;
+    
+    const float x1 = x0 - i1 + G2;
+    const float y1 = y0 - j1 + G2;
+    const float x2 = x0 - 1.0f + 2.0f * G2;
+    const float y2 = y0 - 1.0f + 2.0f * G2;
+    
+    const float n0 = corner(x0, y0, perm(i + perm(j)));
+    const float n1 = corner(x1, y1, perm(i + i1 + perm(j + j1)));
+    const float n2 = corner(x2, y2, perm(i + 1 + perm(j + 1)));
+    
+    output[n] = 40.0f * (n0 + n1 + n2);
+  }
+}
+
 void Noise::begin(glm::vec2 resolution, Noise::Settings settings, bool useTexture)
 {
   const ofShader & shader = _getPerlinShader();
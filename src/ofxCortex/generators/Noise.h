@@ -46,6 +46,10 @@ public:
   
   static double getNoise(glm::vec3 sample, float scale, float contrast = 1.0f, float contrastBias = 0.5f, float details = 0.5f, float roughness = 1.5f, int octaves = 3, int seed = 80052);
   
+#pragma mark - Noise - Batch Methods
+  // output[i] = ofSignedNoise(x[i], y[i]), the same 2D simplex noise evaluated over whole arrays
+  static void getSignedNoise(const float * x, const float * y, size_t count, float * output);
+  
 #pragma mark - Noise - Pixel/Image Methods
   static void begin(glm::vec2 resolution, Noise::Settings settings, bool useTexture = false);
   static void end(Noise::Settings settings);
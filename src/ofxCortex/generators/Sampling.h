@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <random>
+
 #include "ofMathConstants.h"
 #include "ofUtils.h"
 #include "ofMath.h"
@@ -8,6 +11,10 @@
 #include <glm/vec2.hpp>
 #include "ofxCortex/types/Box.h"
 #include "ofxCortex/spatial/SpatialGrid.h"
+#include "ofxCortex/spatial/EdgeTable.h"
+#include "ofxCortex/spatial/MeshBVH.h"
+#include "ofxCortex/utils/VectorUtils.h"
+#include "ofxCortex/utils/ParallelUtils.h"
 
 namespace ofxCortex { namespace core { namespace generators {
 
@@ -117,132 +124,938 @@ public:
   
   static std::vector<glm::vec3> sample3D(float radius, const ofMesh & mesh, int numSamplesBeforeRejection = 30)
   {
-    radius = MAX(1.0, radius);
+    return sample3D(radius, spatial::MeshBVH(mesh), numSamplesBeforeRejection);
+  }
+  
+  // Re-use the BVH when sampling the same mesh several times.
+  static std::vector<glm::vec3> sample3D(float radius, const spatial::MeshBVH & bvh, int numSamplesBeforeRejection = 30)
+  {
+    if (bvh.empty()) return std::vector<glm::vec3>();
+    
+    const glm::vec3 min = bvh.getMin();
+    const glm::vec3 size = bvh.getMax() - min;
+    
+    return sampleInside3D(MAX(1.0, radius), ofxCortex::core::types::Box(min, size.x, size.y, size.z), [&bvh](const glm::vec3 & p) { return bvh.inside(p); }, numSamplesBeforeRejection);
+  }
+  
+  // 3D counterpart of sampleInside(), restricted to the volume where `isInside(point)` is true.
+  template<typename InsideFunc>
+  static std::vector<glm::vec3> sampleInside3D(float radius, const ofxCortex::core::types::Box & bounds, InsideFunc && isInside, int numSamplesBeforeRejection = 30)
+  {
+    std::vector<glm::vec3> samples;
     
-    float cellSize = radius / 1.41421f;
-    ofxCortex::core::types::Box bounds = ofxCortex::core::utils::getMeshBoundingBox(mesh);
-    ofxCortex::core::types::Box originalBounds = bounds;
-    bounds.x = 0;
-    bounds.y = 0;
-    bounds.z = 0;
+    radius = MAX(radius, std::numeric_limits<float>::epsilon());
+    if (bounds.width <= 0 || bounds.height <= 0 || bounds.depth <= 0) return samples;
     
-    int columns = ceil(bounds.width / cellSize);
-    int rows = ceil(bounds.height / cellSize);
-    int layers = ceil(bounds.depth / cellSize);
+    // At most one sample per cell in 3D, so the cell diagonal must not exceed the radius
+    const float cellSize = radius / 1.73205f;
+    const int columns = MAX((int) ceil(bounds.width / cellSize), 1);
+    const int rows = MAX((int) ceil(bounds.height / cellSize), 1);
+    const int layers = MAX((int) ceil(bounds.depth / cellSize), 1);
+    const size_t numCells = (size_t) columns * rows * layers;
+    const float radius2 = radius * radius;
+    const glm::vec3 origin = bounds.position;
     
-    std::vector<int> grid(columns * rows * layers, -1);
-    std::vector<glm::vec3> points;
-    std::vector<glm::vec3> spawnPoints;
+    std::vector<int> grid(numCells, -1);
+    std::vector<int> active;
+    
+    auto toCell = [&](int x, int y, int z) -> size_t { return x + columns * (y + (size_t) rows * z); };
     
-    auto isValid = [&, bounds](const glm::vec3 & candidate) -> bool {
-      if (bounds.inside(candidate))
+    auto isValid = [&](const glm::vec3 & candidate) -> bool {
+      const glm::vec3 local = candidate - origin;
+      if (local.x < 0.0f || local.y < 0.0f || local.z < 0.0f || local.x >= bounds.width || local.y >= bounds.height || local.z >= bounds.depth) return false;
+      
+      const int cellX = (int)(local.x / cellSize);
+      const int cellY = (int)(local.y / cellSize);
+      const int cellZ = (int)(local.z / cellSize);
+      
+      for (int z = MAX(cellZ - 2, 0); z <= MIN(cellZ + 2, layers - 1); ++z)
       {
-        int cellX = (int)(candidate.x / cellSize);
-        int cellY = (int)(candidate.y / cellSize);
-        int cellZ = (int)(candidate.z / cellSize);
+        for (int y = MAX(cellY - 2, 0); y <= MIN(cellY + 2, rows - 1); ++y)
+        {
+          for (int x = MAX(cellX - 2, 0); x <= MIN(cellX + 2, columns - 1); ++x)
+          {
+            int pointIndex = grid[toCell(x, y, z)];
+            if (pointIndex != -1 && glm::length2(candidate - samples[pointIndex]) < radius2) return false;
+          }
+        }
+      }
+      
+      return isInside(candidate);
+    };
+    
+    auto addSample = [&](const glm::vec3 & sample) {
+      const glm::vec3 local = sample - origin;
+      const int sampleIndex = samples.size();
+      
+      samples.push_back(sample);
+      active.push_back(sampleIndex);
+      grid[toCell(MIN((int)(local.x / cellSize), columns - 1), MIN((int)(local.y / cellSize), rows - 1), MIN((int)(local.z / cellSize), layers - 1))] = sampleIndex;
+    };
+    
+    for (size_t seedCell = 0; seedCell < numCells; seedCell++)
+    {
+      if (grid[seedCell] != -1) continue;
+      
+      const glm::vec3 cell(seedCell % columns, (seedCell / columns) % rows, seedCell / ((size_t) columns * rows));
+      const glm::vec3 seed = origin + (cell + glm::vec3(ofRandom(1.0f), ofRandom(1.0f), ofRandom(1.0f))) * cellSize;
+      
+      if (!isValid(seed)) continue;
+      addSample(seed);
+      
+      while (active.size() > 0)
+      {
+        size_t activeIndex = MIN((size_t) ofRandom(active.size()), active.size() - 1);
+        const glm::vec3 spawnCenter = samples[active[activeIndex]];
         
-        int searchStartX =  MAX(cellX - 2, 0);
-        int searchEndX =    MIN(cellX + 2, columns);
-        int searchStartY =  MAX(cellY - 2, 0);
-        int searchEndY =    MIN(cellY + 2, rows);
-        int searchStartZ =  MAX(cellZ - 2, 0);
-        int searchEndZ =    MIN(cellZ + 2, rows);
+        bool candidateAccepted = false;
         
-        for (int x = searchStartX; x < searchEndX; x++)
+        for (int i = 0; i < numSamplesBeforeRejection; i++)
         {
-          for (int y = searchStartY; y < searchEndY; y++)
+          glm::vec3 candidate = spawnCenter + ofxCortex::core::utils::Vector::random3D(ofRandom(radius, radius * 2.0));
+          
+          if (isValid(candidate))
           {
-            for (int z = searchStartZ; z < searchEndZ; z++)
-            {
-              int gridIndex = x + rows * (y + columns * z);
-              int pointIndex = grid[gridIndex];
-              if (pointIndex != -1 && pointIndex < points.size())
-              {
-                float dst = glm::length2(candidate - points[pointIndex]);
-                if (dst < radius * radius) return false;
-              }
-            }
+            addSample(candidate);
+            candidateAccepted = true;
+            break;
           }
         }
         
-        return true;
+        if (!candidateAccepted)
+        {
+          active[activeIndex] = active.back();
+          active.pop_back();
+        }
       }
+    }
+    
+    return samples;
+  }
+  
+  static std::vector<glm::vec2> insidePolyline(const ofPolyline & source, float radius)
+  {
+    return insidePolygon(spatial::ScanlineEdgeTable(source), radius);
+  }
+  
+  static std::vector<glm::vec2> insidePolygon(const std::vector<ofPolyline> & polygons, float radius, int numSamplesBeforeRejection = 32)
+  {
+    return insidePolygon(spatial::ScanlineEdgeTable(polygons), radius, numSamplesBeforeRejection);
+  }
+  
+  static std::vector<glm::vec2> insidePolygon(const spatial::ScanlineEdgeTable & polygon, float radius, int numSamplesBeforeRejection = 32)
+  {
+    return sampleInside(radius, polygon.getBoundingBox(), [&polygon](const glm::vec2 & p) { return polygon.inside(p); }, numSamplesBeforeRejection);
+  }
+  
+  // Note: reading back the FBO stalls the GPU, prefer passing pixels you already have on the CPU.
+  static std::vector<glm::vec2> fromMask(const ofFbo & mask, float radius, float threshold = 0.9f)
+  {
+    ofFloatPixels pixels;
+    mask.readToPixels(pixels);
+    
+    return fromMask(pixels, radius, threshold);
+  }
+  
+  static std::vector<glm::vec2> fromMask(const ofFloatPixels & mask, float radius, float threshold = 0.9f, int numSamplesBeforeRejection = 32)
+  {
+    const int width = mask.getWidth();
+    const int height = mask.getHeight();
+    const int channels = mask.getNumChannels();
+    const float * data = mask.getData();
+    
+    if (width == 0 || height == 0 || data == nullptr) return std::vector<glm::vec2>();
+    
+    auto isInside = [=](const glm::vec2 & p) -> bool {
+      const int x = (int) p.x;
+      const int y = (int) p.y;
+      if (x < 0 || y < 0 || x >= width || y >= height) return false;
+      
+      const float * pixel = data + (x + y * width) * channels;
+      const float brightness = (channels >= 3) ? MAX(pixel[0], MAX(pixel[1], pixel[2])) : pixel[0];
       
-      return false;
+      return brightness >= threshold;
     };
     
-    spawnPoints.push_back(glm::vec3(bounds.width, bounds.height, bounds.depth) / 2.0f);
+    return sampleInside(radius, ofRectangle(0, 0, width, height), isInside, numSamplesBeforeRejection);
+  }
+  
+  // Poisson disc sampling restricted to the region where `isInside(point)` is true.
+  // Candidates are rejected as they are generated, and every empty grid cell is
+  // probed for a new seed once growth stalls, so disconnected regions are filled too.
+  // Optional `constraints` are existing points the result has to keep its distance
+  // from (they may lie outside `bounds`); they are not part of the returned samples.
+  template<typename InsideFunc>
+  static std::vector<glm::vec2> sampleInside(float radius, const ofRectangle & bounds, InsideFunc && isInside, int numSamplesBeforeRejection = 32, const std::vector<glm::vec2> & constraints = {})
+  {
+    std::vector<glm::vec2> samples;
+    
+    radius = MAX(radius, std::numeric_limits<float>::epsilon());
+    if (bounds.width <= 0 || bounds.height <= 0) return samples;
     
-    int tries = 0;
-    while (spawnPoints.size() > 0)
+    // Constraints closer than `radius` to the bounds still matter, so the grid grows to include them
+    const float margin = (constraints.empty()) ? 0.0f : radius * 2.0f;
+    const float cellSize = radius / 1.41421f;
+    const int columns = MAX((int) ceil((bounds.width + margin * 2.0f) / cellSize), 1);
+    const int rows = MAX((int) ceil((bounds.height + margin * 2.0f) / cellSize), 1);
+    const float radius2 = radius * radius;
+    const glm::vec2 origin(bounds.x - margin, bounds.y - margin);
+    
+    std::vector<int> grid(columns * rows, -1);
+    std::vector<int> active;
+    
+    auto getCell = [&](const glm::vec2 & p) -> int {
+      int col = CLAMP((int)((p.x - origin.x) / cellSize), 0, columns - 1);
+      int row = CLAMP((int)((p.y - origin.y) / cellSize), 0, rows - 1);
+      return col + row * columns;
+    };
+    
+    auto isValid = [&](const glm::vec2 & candidate) -> bool {
+      if (candidate.x < bounds.x || candidate.y < bounds.y || candidate.x >= bounds.x + bounds.width || candidate.y >= bounds.y + bounds.height) return false;
+      
+      const glm::vec2 local = candidate - origin;
+      const int cellX = (int)(local.x / cellSize);
+      const int cellY = (int)(local.y / cellSize);
+      
+      for (int y = MAX(cellY - 2, 0); y <= MIN(cellY + 2, rows - 1); ++y)
+      {
+        for (int x = MAX(cellX - 2, 0); x <= MIN(cellX + 2, columns - 1); ++x)
+        {
+          int pointIndex = grid[x + y * columns];
+          if (pointIndex != -1 && glm::length2(candidate - samples[pointIndex]) < radius2) return false;
+        }
+      }
+      
+      return isInside(candidate);
+    };
+    
+    auto addSample = [&](const glm::vec2 & sample) {
+      const int sampleIndex = samples.size();
+      samples.push_back(sample);
+      active.push_back(sampleIndex);
+      grid[getCell(sample)] = sampleIndex;
+    };
+    
+    for (const auto & constraint : constraints)
+    {
+      const glm::vec2 local = constraint - origin;
+      if (local.x < 0.0f || local.y < 0.0f || local.x >= columns * cellSize || local.y >= rows * cellSize) continue;
+      
+      addSample(constraint);
+    }
+    const size_t numFixed = samples.size();
+    
+    for (int seedCell = 0; seedCell < columns * rows; seedCell++)
+    {
+      if (grid[seedCell] != -1) continue;
+      
+      const glm::vec2 cellOrigin = origin + glm::vec2(seedCell % columns, seedCell / columns) * cellSize;
+      for (int i = 0; i < 4; i++)
+      {
+        glm::vec2 seed = cellOrigin + glm::vec2(ofRandom(cellSize), ofRandom(cellSize));
+        if (isValid(seed)) { addSample(seed); break; }
+      }
+      
+      while (active.size() > 0)
+      {
+        size_t activeIndex = MIN((size_t) ofRandom(active.size()), active.size() - 1);
+        const glm::vec2 currentSample = samples[active[activeIndex]];
+        
+        bool candidateAccepted = false;
+        
+        for (int i = 0; i < numSamplesBeforeRejection; i++)
+        {
+          float a = ofRandom(TWO_PI);
+          glm::vec2 candidate = currentSample + glm::vec2(cos(a), sin(a)) * ofRandom(radius, radius * 2.0f);
+          
+          if (isValid(candidate))
+          {
+            addSample(candidate);
+            candidateAccepted = true;
+            break;
+          }
+        }
+        
+        if (!candidateAccepted)
+        {
+          active[activeIndex] = active.back();
+          active.pop_back();
+        }
+      }
+    }
+    
+    samples.erase(samples.begin(), samples.begin() + numFixed);
+    return samples;
+  }
+  
+private:
+  ofRectangle bounds;
+};
+
+// Incremental version of PoissonDisc::sample. Keeps its grid and active list
+// between calls so generation can be spread across several frames.
+class PoissonDiscGenerator {
+public:
+  PoissonDiscGenerator() {};
+  PoissonDiscGenerator(const ofRectangle & bounds, float radius, int numSamplesBeforeRejection = 30) { setup(bounds, radius, numSamplesBeforeRejection); };
+  
+  void setup(const ofRectangle & bounds, float radius, int numSamplesBeforeRejection = 30)
+  {
+    this->bounds = bounds;
+    this->radius = MAX(radius, std::numeric_limits<float>::epsilon());
+    this->numSamplesBeforeRejection = MAX(numSamplesBeforeRejection, 1);
+    
+    reset();
+  }
+  
+  void reset()
+  {
+    cellSize = radius / 1.41421f;
+    columns = MAX((int) ceil(bounds.width / cellSize), 1);
+    rows = MAX((int) ceil(bounds.height / cellSize), 1);
+    
+    grid.assign(columns * rows, -1);
+    samples.clear();
+    active.clear();
+    
+    addSample(glm::vec2(bounds.width, bounds.height) / 2.0f);
+    isSeeded = false;
+  }
+  
+  // Runs until `maxSamples` new samples are accepted or the generator is exhausted.
+  std::vector<glm::vec2> step(size_t maxSamples)
+  {
+    std::vector<glm::vec2> output;
+    step(maxSamples, std::numeric_limits<float>::max(), output);
+    return output;
+  }
+  
+  // Runs until `maxMillis` has elapsed or the generator is exhausted.
+  std::vector<glm::vec2> stepFor(float maxMillis)
+  {
+    std::vector<glm::vec2> output;
+    step(std::numeric_limits<size_t>::max(), maxMillis, output);
+    return output;
+  }
+  
+  // Appends newly accepted samples to `output` and returns how many were added.
+  size_t step(size_t maxSamples, float maxMillis, std::vector<glm::vec2> & output)
+  {
+    const size_t startSize = output.size();
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration<float, std::milli>(maxMillis);
+    
+    if (!isSeeded)
+    {
+      output.push_back(samples.front() + glm::vec2(bounds.x, bounds.y));
+      isSeeded = true;
+    }
+    
+    int iterations = 0;
+    while (active.size() > 0 && output.size() - startSize < maxSamples)
     {
-      int spawnIndex = (int) (ofRandom(0, spawnPoints.size() - 1));
-      glm::vec3 spawnCenter = spawnPoints[spawnIndex];
+      if ((++iterations & 15) == 0 && std::chrono::steady_clock::now() - start >= budget) break;
+      
+      size_t activeIndex = MIN((size_t) ofRandom(active.size()), active.size() - 1);
+      const glm::vec2 currentSample = samples[active[activeIndex]];
+      
       bool candidateAccepted = false;
       
       for (int i = 0; i < numSamplesBeforeRejection; i++)
       {
-        glm::vec3 candidate = spawnCenter + ofxCortex::core::utils::Vector::random3D(ofRandom(radius, radius * 2.0));
+        float a = ofRandom(TWO_PI);
+        glm::vec2 candidate = currentSample + glm::vec2(cos(a), sin(a)) * ofRandom(radius, radius * 2.0f);
         
         if (isValid(candidate))
         {
-          points.push_back(candidate);
-          spawnPoints.push_back(candidate);
-          
-          int col = (int)(candidate.x / cellSize);
-          int row = (int)(candidate.y / cellSize);
-          int lay = (int)(candidate.z / cellSize);
-          int index = col + rows * (row + columns * lay);
-          grid[index] = points.size() - 1;
+          addSample(candidate);
+          output.push_back(candidate + glm::vec2(bounds.x, bounds.y));
           candidateAccepted = true;
           break;
         }
       }
       
-      if (!candidateAccepted) spawnPoints.erase(spawnPoints.begin() + spawnIndex);
-      
-      tries++;
+      if (!candidateAccepted)
+      {
+        active[activeIndex] = active.back();
+        active.pop_back();
+      }
     }
     
-    for (auto & point : points) point += originalBounds.position;
+    return output.size() - startSize;
+  }
+  
+  bool isFinished() const { return active.empty(); }
+  size_t size() const { return samples.size(); }
+  
+  std::vector<glm::vec2> getSamples() const
+  {
+    std::vector<glm::vec2> output = samples;
+    for (auto & point : output) point += glm::vec2(bounds.x, bounds.y);
+    return output;
+  }
+  
+  const ofRectangle & getBounds() const { return bounds; }
+  float getRadius() const { return radius; }
+
+protected:
+  ofRectangle bounds;
+  float radius { 10.0f };
+  int numSamplesBeforeRejection { 30 };
+  
+  float cellSize { 1.0f };
+  int columns { 0 };
+  int rows { 0 };
+  bool isSeeded { false };
+  
+  std::vector<int> grid;
+  std::vector<int> active;
+  std::vector<glm::vec2> samples;
+  
+  void addSample(const glm::vec2 & sample)
+  {
+    const int sampleIndex = samples.size();
     
-    std::vector<glm::vec3> output;
-    std::copy_if(points.begin(), points.end(), back_inserter(output), [&mesh](const glm::vec3 & p) { return ofxCortex::core::utils::isInsideMesh(p, mesh); });
+    samples.push_back(sample);
+    active.push_back(sampleIndex);
     
-    return output;
+    int col = CLAMP((int)(sample.x / cellSize), 0, columns - 1);
+    int row = CLAMP((int)(sample.y / cellSize), 0, rows - 1);
+    
+    grid[col + row * columns] = sampleIndex;
   }
   
-  static std::vector<glm::vec2> insidePolyline(const ofPolyline & source, float radius)
+  bool isValid(const glm::vec2 & candidate) const
   {
-    std::vector<glm::vec2> samples = sample(radius, source.getBoundingBox());
+    if (candidate.x < 0.0f || candidate.y < 0.0f || candidate.x >= bounds.width || candidate.y >= bounds.height) return false;
     
-    std::vector<glm::vec2> output;
-    for (const glm::vec2 & point : samples)
+    const float radius2 = radius * radius;
+    
+    const int cellX = (int)(candidate.x / cellSize);
+    const int cellY = (int)(candidate.y / cellSize);
+    
+    const int searchStartX = MAX(cellX - 2, 0);
+    const int searchEndX =   MIN(cellX + 2, columns - 1);
+    const int searchStartY = MAX(cellY - 2, 0);
+    const int searchEndY =   MIN(cellY + 2, rows - 1);
+    
+    for (int y = searchStartY; y <= searchEndY; ++y)
     {
-      if (source.inside(point.x, point.y)) output.push_back(point);
+      for (int x = searchStartX; x <= searchEndX; ++x)
+      {
+        int pointIndex = grid[x + y * columns];
+        if (pointIndex != -1 && glm::length2(candidate - samples[pointIndex]) < radius2) return false;
+      }
     }
     
+    return true;
+  }
+};
+
+// Low-discrepancy sequences: well spread but not strictly Poisson, and much
+// cheaper. Every point is a pure function of its index, so fill() can start at
+// any index and disjoint index ranges can be generated on separate threads
+// (see fillParallel). Inner loops are branch-free over flat output so the
+// compiler can vectorise them.
+namespace Sequence {
+
+inline static uint32_t reverseBits(uint32_t bits)
+{
+  bits = (bits << 16) | (bits >> 16);
+  bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+  bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+  bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+  bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+  return bits;
+}
+
+// Top 24 bits to a float in [0, 1)
+inline static float toUnitFloat(uint32_t bits) { return (bits >> 8) * (1.0f / 16777216.0f); }
+
+inline static uint32_t hash(uint32_t x)
+{
+  x ^= x >> 16; x *= 0x7FEB352Du;
+  x ^= x >> 15; x *= 0x846CA68Bu;
+  x ^= x >> 16;
+  return x;
+}
+
+}
+
+// Halton sequence, bases 2 and 3 by default.
+struct Halton {
+  static float radicalInverse(uint32_t index, uint32_t base)
+  {
+    if (base == 2) return Sequence::toUnitFloat(Sequence::reverseBits(index));
+    
+    const float invBase = 1.0f / base;
+    float inverse = 0.0f;
+    float factor = invBase;
+    while (index > 0)
+    {
+      inverse += (index % base) * factor;
+      index /= base;
+      factor *= invBase;
+    }
+    return MIN(inverse, 0.99999994f);
+  }
+  
+  static glm::vec2 get(uint32_t index, uint32_t baseX = 2, uint32_t baseY = 3)
+  {
+    return glm::vec2(radicalInverse(index, baseX), radicalInverse(index, baseY));
+  }
+  
+  static void fill(glm::vec2 * output, size_t count, const ofRectangle & bounds, uint32_t first = 0, uint32_t baseX = 2, uint32_t baseY = 3)
+  {
+    const glm::vec2 origin(bounds.x, bounds.y), size(bounds.width, bounds.height);
+    for (size_t i = 0; i < count; i++) output[i] = origin + get(first + i, baseX, baseY) * size;
+  }
+  
+  static std::vector<glm::vec2> sample(size_t count, const ofRectangle & bounds, uint32_t first = 0)
+  {
+    std::vector<glm::vec2> output(count);
+    fill(output.data(), count, bounds, first);
     return output;
   }
+};
+
+// 2D Sobol sequence (van der Corput in x, the degree 1 primitive polynomial in y).
+// A non-zero `scramble` applies a random digital shift, which keeps the
+// stratification but decorrelates sets generated with different seeds.
+struct Sobol {
+  static glm::vec2 get(uint32_t index, uint32_t scramble = 0)
+  {
+    return get(index, getShiftX(scramble), getShiftY(scramble));
+  }
   
-  static std::vector<glm::vec2> fromMask(const ofFbo & mask, float radius, float threshold = 0.9f)
+  static void fill(glm::vec2 * output, size_t count, const ofRectangle & bounds, uint32_t first = 0, uint32_t scramble = 0)
+  {
+    const uint32_t shiftX = getShiftX(scramble), shiftY = getShiftY(scramble);
+    const glm::vec2 origin(bounds.x, bounds.y), size(bounds.width, bounds.height);
+    for (size_t i = 0; i < count; i++) output[i] = origin + get(first + i, shiftX, shiftY) * size;
+  }
+  
+  static std::vector<glm::vec2> sample(size_t count, const ofRectangle & bounds, uint32_t first = 0, uint32_t scramble = 0)
+  {
+    std::vector<glm::vec2> output(count);
+    fill(output.data(), count, bounds, first, scramble);
+    return output;
+  }
+  
+protected:
+  static uint32_t getShiftX(uint32_t scramble) { return (scramble) ? Sequence::hash(scramble) : 0; }
+  static uint32_t getShiftY(uint32_t scramble) { return (scramble) ? Sequence::hash(scramble ^ 0x9E3779B9u) : 0; }
+  
+  static glm::vec2 get(uint32_t index, uint32_t shiftX, uint32_t shiftY)
   {
-    ofRectangle bb(0, 0, mask.getWidth(), mask.getHeight());
-    std::vector<glm::vec2> samples = sample(radius, bb);
+    return glm::vec2(Sequence::toUnitFloat(Sequence::reverseBits(index) ^ shiftX), Sequence::toUnitFloat(sobolY(index) ^ shiftY));
+  }
+  
+  // Direction numbers v[k] = v[k-1] ^ (v[k-1] >> 1), starting at 1 << 31
+  static uint32_t sobolY(uint32_t index)
+  {
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index; index >>= 1, v ^= v >> 1)
+    {
+      result ^= v & (0u - (index & 1u));
+    }
+    return result;
+  }
+};
+
+// Additive recurrence on the plastic number (Roberts' R2 sequence). The
+// cheapest of the lot and very even for any prefix length.
+struct R2 {
+  static glm::vec2 get(uint32_t index, float offset = 0.5f)
+  {
+    // Accumulate in double, float loses the fractional part after a few million points
+    static const double alphaX = 0.75487766624669276005;
+    static const double alphaY = 0.56984029099805326591;
     
-    ofFloatPixels pixels;
-    mask.readToPixels(pixels);
+    const double x = offset + alphaX * index;
+    const double y = offset + alphaY * index;
+    return glm::vec2(x - floor(x), y - floor(y));
+  }
+  
+  static void fill(glm::vec2 * output, size_t count, const ofRectangle & bounds, uint32_t first = 0, float offset = 0.5f)
+  {
+    const glm::vec2 origin(bounds.x, bounds.y), size(bounds.width, bounds.height);
+    for (size_t i = 0; i < count; i++) output[i] = origin + get(first + i, offset) * size;
+  }
+  
+  static std::vector<glm::vec2> sample(size_t count, const ofRectangle & bounds, uint32_t first = 0, float offset = 0.5f)
+  {
+    std::vector<glm::vec2> output(count);
+    fill(output.data(), count, bounds, first, offset);
+    return output;
+  }
+};
+
+// One uniformly jittered point per cell of a columns x rows grid, in row order.
+// The jitter is hashed from (index, seed), so any cell can be generated alone.
+struct JitteredGrid {
+  static glm::vec2 get(uint32_t index, int columns, int rows, uint32_t seed = 0)
+  {
+    const uint32_t h = Sequence::hash(index * 2 + seed * 0x9E3779B9u);
+    const glm::vec2 jitter(Sequence::toUnitFloat(h), Sequence::toUnitFloat(Sequence::hash(h ^ 0x68E31DA4u)));
     
-    std::vector<glm::vec2> output;
-    for (const glm::vec2 & point : samples)
+    return (glm::vec2(index % columns, index / columns) + jitter) / glm::vec2(columns, rows);
+  }
+  
+  static void fill(glm::vec2 * output, size_t count, const ofRectangle & bounds, uint32_t first, int columns, int rows, uint32_t seed = 0)
+  {
+    columns = MAX(columns, 1);
+    rows = MAX(rows, 1);
+    
+    const glm::vec2 origin(bounds.x, bounds.y), size(bounds.width, bounds.height);
+    for (size_t i = 0; i < count; i++) output[i] = origin + get(first + i, columns, rows, seed) * size;
+  }
+  
+  // Picks a grid close to square cells holding at least `count` points and returns all of them
+  static std::vector<glm::vec2> sample(size_t count, const ofRectangle & bounds, uint32_t seed = 0)
+  {
+    if (count == 0 || bounds.width <= 0 || bounds.height <= 0) return {};
+    
+    const int columns = MAX((int) ceil(sqrt(count * bounds.width / bounds.height)), 1);
+    const int rows = MAX((int) ceil((double) count / columns), 1);
+    
+    std::vector<glm::vec2> output(columns * rows);
+    fill(output.data(), output.size(), bounds, 0, columns, rows, seed);
+    return output;
+  }
+};
+
+// Splits [first, first + count) across the shared worker pool. Extra arguments
+// are passed through to Generator::fill, e.g. fillParallel<Sobol>(out, n, bounds, 0, seed).
+template<typename Generator, typename... Args>
+inline static void fillParallel(glm::vec2 * output, size_t count, const ofRectangle & bounds, uint32_t first = 0, Args... args)
+{
+  utils::Parallel::forRange(count, [&](size_t begin, size_t end) {
+    Generator::fill(output + begin, end - begin, bounds, first + begin, args...);
+  }, 4096);
+}
+
+// Walker/Vose alias table: O(n) to build, O(1) to draw an index with
+// probability proportional to its weight.
+class AliasTable {
+public:
+  AliasTable() = default;
+  AliasTable(const std::vector<float> & weights) { setup(weights); }
+  
+  void setup(const std::vector<float> & weights)
+  {
+    const size_t n = weights.size();
+    probabilities.assign(n, 0.0f);
+    aliases.assign(n, 0);
+    
+    if (n == 0) return;
+    
+    double total = 0.0;
+    for (float weight : weights) total += MAX(weight, 0.0f);
+    
+    std::vector<double> scaled(n);
+    std::vector<unsigned int> small, large;
+    small.reserve(n); large.reserve(n);
+    
+    for (size_t i = 0; i < n; i++)
     {
-      if (pixels.getColor(point.x, point.y).getBrightness() >= threshold) output.push_back(point);
+      scaled[i] = (total > 0.0) ? MAX(weights[i], 0.0f) * n / total : 1.0;
+      if (scaled[i] < 1.0) small.push_back(i);
+      else large.push_back(i);
     }
-    return output;
+    
+    while (!small.empty() && !large.empty())
+    {
+      unsigned int less = small.back(); small.pop_back();
+      unsigned int more = large.back(); large.pop_back();
+      
+      probabilities[less] = scaled[less];
+      aliases[less] = more;
+      
+      scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+      if (scaled[more] < 1.0) small.push_back(more);
+      else large.push_back(more);
+    }
+    
+    for (unsigned int i : large) probabilities[i] = 1.0f;
+    for (unsigned int i : small) probabilities[i] = 1.0f;
   }
   
-private:
+  // `u` and `v` are independent uniform numbers in [0, 1)
+  unsigned int sample(float u, float v) const
+  {
+    const unsigned int column = MIN((unsigned int)(u * probabilities.size()), (unsigned int) probabilities.size() - 1);
+    return (v < probabilities[column]) ? column : aliases[column];
+  }
+  
+  size_t size() const { return probabilities.size(); }
+  
+protected:
+  std::vector<float> probabilities;
+  std::vector<unsigned int> aliases;
+};
+
+// Blue-noise points on the surface of a triangle mesh. Dense, area-weighted
+// candidates are generated in parallel and then thinned to a Poisson disc set
+// with a spatial hash.
+class MeshSurfaceSampler {
+public:
+  MeshSurfaceSampler() = default;
+  MeshSurfaceSampler(const ofMesh & mesh) { setup(mesh); }
+  
+  void setup(const ofMesh & mesh)
+  {
+    triangles.clear();
+    surfaceArea = 0.0f;
+    
+    if (mesh.getMode() != OF_PRIMITIVE_TRIANGLES)
+    {
+      ofLogWarning("MeshSurfaceSampler::setup") << "ofMesh mode should be OF_PRIMITIVE_TRIANGLES";
+      return;
+    }
+    
+    const auto & vertices = mesh.getVertices();
+    const auto & indices = mesh.getIndices();
+    const size_t numCorners = (mesh.hasIndices()) ? indices.size() : vertices.size();
+    
+    std::vector<float> areas;
+    areas.reserve(numCorners / 3);
+    triangles.reserve(numCorners / 3);
+    
+    for (size_t i = 0; i + 2 < numCorners; i += 3)
+    {
+      const glm::vec3 & a = vertices[(mesh.hasIndices()) ? indices[i + 0] : i + 0];
+      const glm::vec3 & b = vertices[(mesh.hasIndices()) ? indices[i + 1] : i + 1];
+      const glm::vec3 & c = vertices[(mesh.hasIndices()) ? indices[i + 2] : i + 2];
+      
+      const glm::vec3 cross = glm::cross(b - a, c - a);
+      const float area = glm::length(cross) * 0.5f;
+      
+      triangles.push_back({ a, b - a, c - a, (area > 0.0f) ? cross / (area * 2.0f) : glm::vec3(0, 0, 1) });
+      areas.push_back(area);
+      surfaceArea += area;
+    }
+    
+    aliasTable.setup(areas);
+  }
+  
+  // Uniform (white noise) points over the surface. Deterministic for a given seed,
+  // regardless of how many threads end up doing the work.
+  void sampleUniform(size_t count, std::vector<glm::vec3> & points, std::vector<glm::vec3> * normals = nullptr, unsigned int seed = 0) const
+  {
+    points.resize(count);
+    if (normals) normals->resize(count);
+    
+    if (triangles.empty() || count == 0) return;
+    
+    const size_t chunkSize = 4096;
+    const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+    
+    utils::Parallel::forEach(numChunks, [&](size_t chunk) {
+      std::mt19937 random(seed ^ (unsigned int)(chunk * 0x9E3779B9u));
+      auto uniform = [&random]() { return (random() >> 8) * (1.0f / 16777216.0f); };
+      
+      const size_t end = MIN((chunk + 1) * chunkSize, count);
+      for (size_t i = chunk * chunkSize; i < end; i++)
+      {
+        const Triangle & triangle = triangles[aliasTable.sample(uniform(), uniform())];
+        
+        float u = uniform();
+        float v = uniform();
+        if (u + v > 1.0f) { u = 1.0f - u; v = 1.0f - v; }
+        
+        points[i] = triangle.v0 + triangle.e1 * u + triangle.e2 * v;
+        if (normals) (*normals)[i] = triangle.normal;
+      }
+    });
+  }
+  
+  // Poisson disc points on the surface, at least `radius` apart (euclidean distance).
+  // `candidatesPerSample` controls how many uniform candidates are thinned per expected output point.
+  void samplePoissonDisc(float radius, std::vector<glm::vec3> & points, std::vector<glm::vec3> * normals = nullptr, float candidatesPerSample = 8.0f, unsigned int seed = 0) const
+  {
+    points.clear();
+    if (normals) normals->clear();
+    
+    radius = MAX(radius, std::numeric_limits<float>::epsilon());
+    if (triangles.empty()) return;
+    
+    // A maximal disc packing holds at most ~1.15 / r^2 points per unit area
+    const size_t expected = (size_t) ceil(surfaceArea / (radius * radius)) + 1;
+    const size_t numCandidates = (size_t) ceil(expected * MAX(candidatesPerSample, 1.0f));
+    
+    std::vector<glm::vec3> candidates;
+    std::vector<glm::vec3> candidateNormals;
+    sampleUniform(numCandidates, candidates, (normals) ? &candidateNormals : nullptr, seed);
+    
+    // Open-addressed hash from cell to the first point in it, points in the same cell are chained
+    size_t capacity = 1024;
+    while (capacity < expected * 2) capacity <<= 1;
+    
+    const int64_t EMPTY = std::numeric_limits<int64_t>::min();
+    std::vector<int64_t> keys(capacity, EMPTY);
+    std::vector<int> heads(capacity, -1);
+    std::vector<int> next;
+    next.reserve(expected);
+    points.reserve(expected);
+    
+    auto getKey = [](int x, int y, int z) -> int64_t { return ((int64_t)(x & 0x1FFFFF) << 42) | ((int64_t)(y & 0x1FFFFF) << 21) | (int64_t)(z & 0x1FFFFF); };
+    auto findSlot = [&](int64_t key) -> size_t {
+      size_t slot = (size_t)((uint64_t) key * 0x9E3779B97F4A7C15ull >> 20) & (capacity - 1);
+      while (keys[slot] != EMPTY && keys[slot] != key) slot = (slot + 1) & (capacity - 1);
+      return slot;
+    };
+    
+    const float inverseCellSize = 1.0f / radius;
+    const float radius2 = radius * radius;
+    
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+      const glm::vec3 & candidate = candidates[i];
+      const int cellX = (int) floor(candidate.x * inverseCellSize);
+      const int cellY = (int) floor(candidate.y * inverseCellSize);
+      const int cellZ = (int) floor(candidate.z * inverseCellSize);
+      
+      bool isFree = true;
+      for (int z = cellZ - 1; z <= cellZ + 1 && isFree; z++)
+      {
+        for (int y = cellY - 1; y <= cellY + 1 && isFree; y++)
+        {
+          for (int x = cellX - 1; x <= cellX + 1 && isFree; x++)
+          {
+            const size_t slot = findSlot(getKey(x, y, z));
+            for (int pointIndex = heads[slot]; pointIndex != -1; pointIndex = next[pointIndex])
+            {
+              if (glm::length2(candidate - points[pointIndex]) < radius2) { isFree = false; break; }
+            }
+          }
+        }
+      }
+      
+      if (!isFree) continue;
+      
+      if (points.size() * 2 >= capacity) break; // Can not happen for a valid packing, guards the probing loop
+      
+      const int64_t key = getKey(cellX, cellY, cellZ);
+      const size_t slot = findSlot(key);
+      keys[slot] = key;
+      next.push_back(heads[slot]);
+      heads[slot] = points.size();
+      
+      points.push_back(candidate);
+      if (normals) normals->push_back(candidateNormals[i]);
+    }
+  }
+  
+  std::vector<glm::vec3> samplePoissonDisc(float radius, float candidatesPerSample = 8.0f, unsigned int seed = 0) const
+  {
+    std::vector<glm::vec3> points;
+    samplePoissonDisc(radius, points, nullptr, candidatesPerSample, seed);
+    return points;
+  }
+  
+  float getSurfaceArea() const { return surfaceArea; }
+  size_t getNumTriangles() const { return triangles.size(); }
+  
+protected:
+  struct Triangle {
+    glm::vec3 v0;
+    glm::vec3 e1;
+    glm::vec3 e2;
+    glm::vec3 normal;
+  };
+  
+  std::vector<Triangle> triangles;
+  AliasTable aliasTable;
+  float surfaceArea { 0.0f };
+};
+
+// Radius field baked onto a regular grid, so samplers do a bilinear lookup
+// instead of calling back into user code for every candidate.
+class RadiusRaster {
+public:
+  RadiusRaster() = default;
+  RadiusRaster(const ofRectangle & bounds, float texelSize, const std::function<float(const glm::vec2&)> & radiusLookup) { bake(bounds, texelSize, radiusLookup); }
+  
+  void bake(const ofRectangle & bounds, float texelSize, const std::function<float(const glm::vec2&)> & radiusLookup)
+  {
+    texelSize = MAX(texelSize, std::numeric_limits<float>::epsilon());
+    
+    this->bounds = bounds;
+    columns = MAX((int) ceil(bounds.width / texelSize), 1) + 1;
+    rows = MAX((int) ceil(bounds.height / texelSize), 1) + 1;
+    setTexelSize();
+    values.resize(columns * rows);
+    
+    for (int y = 0; y < rows; y++)
+    {
+      for (int x = 0; x < columns; x++) values[x + y * columns] = radiusLookup(glm::vec2(bounds.x + x * this->texelSize.x, bounds.y + y * this->texelSize.y));
+    }
+  }
+  
+  // Maps the brightness of `pixels` stretched over `bounds` to [minRadius, maxRadius]
+  static RadiusRaster fromPixels(const ofFloatPixels & pixels, const ofRectangle & bounds, float minRadius, float maxRadius)
+  {
+    RadiusRaster raster;
+    raster.bounds = bounds;
+    raster.columns = MAX((int) pixels.getWidth(), 1);
+    raster.rows = MAX((int) pixels.getHeight(), 1);
+    raster.setTexelSize();
+    raster.values.assign(raster.columns * raster.rows, minRadius);
+    
+    const int channels = pixels.getNumChannels();
+    const float * data = pixels.getData();
+    if (data == nullptr) return raster;
+    
+    for (size_t i = 0; i < raster.values.size(); i++)
+    {
+      const float * pixel = data + i * channels;
+      const float brightness = (channels >= 3) ? MAX(pixel[0], MAX(pixel[1], pixel[2])) : pixel[0];
+      raster.values[i] = ofLerp(minRadius, maxRadius, ofClamp(brightness, 0.0f, 1.0f));
+    }
+    
+    return raster;
+  }
+  
+  float lookup(const glm::vec2 & p) const
+  {
+    if (values.empty()) return 0.0f;
+    
+    const float fx = ofClamp((p.x - bounds.x) / texelSize.x, 0.0f, columns - 1.0f);
+    const float fy = ofClamp((p.y - bounds.y) / texelSize.y, 0.0f, rows - 1.0f);
+    
+    const int x0 = MIN((int) fx, MAX(columns - 2, 0));
+    const int y0 = MIN((int) fy, MAX(rows - 2, 0));
+    const int x1 = MIN(x0 + 1, columns - 1);
+    const int y1 = MIN(y0 + 1, rows - 1);
+    const float tx = fx - x0;
+    const float ty = fy - y0;
+    
+    const float top = ofLerp(values[x0 + y0 * columns], values[x1 + y0 * columns], tx);
+    const float bottom = ofLerp(values[x0 + y1 * columns], values[x1 + y1 * columns], tx);
+    
+    return ofLerp(top, bottom, ty);
+  }
+  
+  float operator()(const glm::vec2 & p) const { return lookup(p); }
+  
+  const ofRectangle & getBounds() const { return bounds; }
+  const glm::vec2 & getTexelSize() const { return texelSize; }
+  
+protected:
   ofRectangle bounds;
+  glm::vec2 texelSize { 1.0f, 1.0f };
+  int columns { 0 };
+  int rows { 0 };
+  std::vector<float> values;
+  
+  // Spacing of the samples on each axis, so the last column and row land on the far edges of `bounds`
+  void setTexelSize()
+  {
+    const float epsilon = std::numeric_limits<float>::epsilon();
+    texelSize.x = MAX(bounds.width / MAX(columns - 1, 1), epsilon);
+    texelSize.y = MAX(bounds.height / MAX(rows - 1, 1), epsilon);
+  }
 };
 
 class VariablePoissonDisc {
@@ -250,53 +1063,177 @@ public:
   
   static std::vector<glm::vec2> sample(const ofRectangle & bounds, float minRadius, float maxRadius, std::function<float(const glm::vec2&)> radiusLookup)
   {
-    const int rejectionLimit = 30;
-    
-    auto spatialGrid = spatial::SpatialGrid2D<int>(bounds.width, bounds.height, minRadius, maxRadius);
-    std::vector<int> activeList(spatialGrid.cellsPerX * spatialGrid.cellsPerY);
+    return sampleWithLookup(bounds, minRadius, maxRadius, radiusLookup);
+  }
+  
+  // Bakes `radiusLookup` into a RadiusRaster first (texel size defaults to minRadius).
+  static std::vector<glm::vec2> sampleBaked(const ofRectangle & bounds, float minRadius, float maxRadius, const std::function<float(const glm::vec2&)> & radiusLookup, float texelSize = 0.0f, int rejectionLimit = 30, std::vector<float> * radii = nullptr)
+  {
+    return sample(bounds, minRadius, maxRadius, RadiusRaster(bounds, (texelSize > 0.0f) ? texelSize : minRadius, radiusLookup), rejectionLimit, radii);
+  }
+  
+  static std::vector<glm::vec2> sample(const ofRectangle & bounds, float minRadius, float maxRadius, const RadiusRaster & raster, int rejectionLimit = 30, std::vector<float> * radii = nullptr)
+  {
+    return sampleWithLookup(bounds, minRadius, maxRadius, raster, rejectionLimit, radii);
+  }
+  
+  // Two samples conflict when closer than the larger of their radii. Samples live in
+  // a stack of grids with cell sizes minRadius * 2^level: each sample is stored at the
+  // level matching its radius and in a cumulative list of every coarser level, so a
+  // query visits 3x3 cells per level no matter how far apart min and max radius are.
+  template<typename Lookup>
+  static std::vector<glm::vec2> sampleWithLookup(const ofRectangle & bounds, float minRadius, float maxRadius, Lookup && radiusLookup, int rejectionLimit = 30, std::vector<float> * radii = nullptr)
+  {
     std::vector<glm::vec2> samples;
+    std::vector<float> sampleRadii;
+    
+    minRadius = MAX(minRadius, std::numeric_limits<float>::epsilon());
+    maxRadius = MAX(maxRadius, minRadius);
+    
+    if (bounds.width <= 0 || bounds.height <= 0) return samples;
     
-    auto addSample = [&](const glm::vec2 & sample) 
+    struct Level {
+      float cellSize;
+      int columns;
+      int rows;
+      std::vector<int> homed;
+      std::vector<int> cumulative;
+    };
+    
+    struct Entry {
+      int sample;
+      int next;
+    };
+    
+    const int numLevels = (int) ceil(log2(maxRadius / minRadius)) + 1;
+    std::vector<Level> levels(numLevels);
+    std::vector<Entry> entries;
+    
+    for (int i = 0; i < numLevels; i++)
     {
-      int sampleIndex = samples.size();
+      Level & level = levels[i];
+      level.cellSize = minRadius * (1 << i);
+      level.columns = MAX((int) ceil(bounds.width / level.cellSize), 1);
+      level.rows = MAX((int) ceil(bounds.height / level.cellSize), 1);
+      level.homed.assign(level.columns * level.rows, -1);
+      level.cumulative.assign(level.columns * level.rows, -1);
+    }
+    
+    auto getLevel = [&](float radius) -> int {
+      int level = CLAMP((int) ceil(log2(radius / minRadius) - 1e-4f), 0, numLevels - 1);
+      while (level < numLevels - 1 && levels[level].cellSize < radius) level++;
+      return level;
+    };
+    auto getCell = [&](const Level & level, const glm::vec2 & local, int & x, int & y) {
+      x = CLAMP((int)(local.x / level.cellSize), 0, level.columns - 1);
+      y = CLAMP((int)(local.y / level.cellSize), 0, level.rows - 1);
+    };
+    auto getRadius = [&](const glm::vec2 & p) -> float { return ofClamp(radiusLookup(p), minRadius, maxRadius); };
+    
+    const glm::vec2 origin(bounds.x, bounds.y);
+    
+    auto scan = [&](const std::vector<int> & heads, const Level & level, const glm::vec2 & candidate, float radius, int cellX, int cellY) -> bool {
+      for (int y = MAX(cellY - 1, 0); y <= MIN(cellY + 1, level.rows - 1); y++)
+      {
+        for (int x = MAX(cellX - 1, 0); x <= MIN(cellX + 1, level.columns - 1); x++)
+        {
+          for (int entry = heads[x + y * level.columns]; entry != -1; entry = entries[entry].next)
+          {
+            const int other = entries[entry].sample;
+            const float distance = MAX(radius, sampleRadii[other]);
+            if (glm::length2(candidate - samples[other]) < distance * distance) return false;
+          }
+        }
+      }
+      return true;
+    };
+    
+    auto isValid = [&](const glm::vec2 & candidate, float radius) -> bool {
+      const glm::vec2 local = candidate - origin;
+      if (local.x < 0.0f || local.y < 0.0f || local.x >= bounds.width || local.y >= bounds.height) return false;
+      
+      const int home = getLevel(radius);
+      int cellX, cellY;
       
+      // Every sample with a radius up to this level's cell size
+      getCell(levels[home], local, cellX, cellY);
+      if (!scan(levels[home].cumulative, levels[home], candidate, radius, cellX, cellY)) return false;
+      
+      // Larger samples, each level only holds radii up to its own cell size
+      for (int i = home + 1; i < numLevels; i++)
+      {
+        getCell(levels[i], local, cellX, cellY);
+        if (!scan(levels[i].homed, levels[i], candidate, radius, cellX, cellY)) return false;
+      }
+      
+      return true;
+    };
+    
+    std::vector<int> active;
+    
+    auto addSample = [&](const glm::vec2 & sample, float radius) {
+      const int sampleIndex = samples.size();
       samples.push_back(sample);
-      activeList.push_back(sampleIndex);
+      sampleRadii.push_back(radius);
+      active.push_back(sampleIndex);
+      
+      const glm::vec2 local = sample - origin;
+      const int home = getLevel(radius);
+      int cellX, cellY;
+      
+      getCell(levels[home], local, cellX, cellY);
+      int & homedHead = levels[home].homed[cellX + cellY * levels[home].columns];
+      entries.push_back({ sampleIndex, homedHead });
+      homedHead = entries.size() - 1;
+      
+      for (int i = home; i < numLevels; i++)
+      {
+        getCell(levels[i], local, cellX, cellY);
+        int & head = levels[i].cumulative[cellX + cellY * levels[i].columns];
+        entries.push_back({ sampleIndex, head });
+        head = entries.size() - 1;
+      }
     };
     
-    glm::vec2 firstSample { ofRandom(bounds.width), ofRandom(bounds.height) };
-    addSample(firstSample);
+    glm::vec2 firstSample = origin + glm::vec2(ofRandom(bounds.width), ofRandom(bounds.height));
+    addSample(firstSample, getRadius(firstSample));
     
-    while (activeList.size() > 0)
+    while (active.size() > 0)
     {
-      bool sampleFound = false;
-      int activeIndex = floor(ofRandom(activeList.size()));
+      size_t activeIndex = MIN((size_t) ofRandom(active.size()), active.size() - 1);
+      const glm::vec2 currentSample = samples[active[activeIndex]];
+      const float currentRadius = sampleRadii[active[activeIndex]];
       
-      glm::vec2 currentSample = samples[activeList[activeIndex]];
-      float radius = radiusLookup(currentSample);
+      bool sampleFound = false;
       
       for (int i = 0; i < rejectionLimit; ++i)
       {
-        glm::vec2 randomSample = currentSample + ofxCortex::core::utils::Vector::random2D(ofRandom(radius, radius * 2.0));
+        float a = ofRandom(TWO_PI);
+        glm::vec2 candidate = currentSample + glm::vec2(cos(a), sin(a)) * ofRandom(currentRadius, currentRadius * 2.0f);
         
-        if (spatialGrid.addIfOpen(samples.size(), randomSample.x, randomSample.y, radius))
+        const glm::vec2 local = candidate - origin;
+        if (local.x < 0.0f || local.y < 0.0f || local.x >= bounds.width || local.y >= bounds.height) continue;
+        
+        const float radius = getRadius(candidate);
+        if (isValid(candidate, radius))
         {
-          addSample(randomSample);
+          addSample(candidate, radius);
           sampleFound = true;
-          
           break;
         }
       }
       
-      if (!sampleFound) activeList.erase(activeList.begin() + activeIndex);
+      if (!sampleFound)
+      {
+        active[activeIndex] = active.back();
+        active.pop_back();
+      }
     }
     
+    if (radii) *radii = std::move(sampleRadii);
+    
     return samples;
   }
-  
-private:
-  
-  
 };
 
 }}}
@@ -0,0 +1,278 @@
+#include "DistanceField.h"
+
+#include "ofLog.h"
+#include "ofxCortex/spatial/EdgeTable.h"
+#include "ofxCortex/spatial/SegmentBVH.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+namespace {
+
+typedef spatial::EdgeGrid::Edge Segment;
+
+inline float getDistance2(const Segment & segment, const glm::vec2 & p) { return spatial::EdgeGrid::getDistance2(segment, p); }
+
+// Lower envelope of the parabolas weight * (x - q)^2 + f[q] (Felzenszwalb & Huttenlocher).
+// Writes the minimum and the q it comes from, or FLT_MAX and -1 when every f[q] is FLT_MAX.
+class Envelope {
+public:
+  Envelope(int count) : vertices(count), boundaries(count + 1) {}
+  
+  void transform(const float * f, int count, float weight, float * output, int * source)
+  {
+    const float scale = 0.5f / weight;
+    
+    int k = -1;
+    for (int q = 0; q < count; q++)
+    {
+      if (f[q] == std::numeric_limits<float>::max()) continue;
+      
+      // Intersection with the parabola of v, written so it stays precise for large q
+      float s = -std::numeric_limits<float>::max();
+      while (k >= 0)
+      {
+        const int v = vertices[k];
+        s = (f[q] - f[v]) * scale / (q - v) + (q + v) * 0.5f;
+        if (s > boundaries[k]) break;
+        k--;
+      }
+      
+      k++;
+      vertices[k] = q;
+      boundaries[k] = (k == 0) ? -std::numeric_limits<float>::max() : s;
+      boundaries[k + 1] = std::numeric_limits<float>::max();
+    }
+    
+    for (int x = 0, j = 0; x < count; x++)
+    {
+      if (k < 0) { output[x] = std::numeric_limits<float>::max(); source[x] = -1; continue; }
+      
+      while (boundaries[j + 1] < x) j++;
+      const int q = vertices[j];
+      output[x] = weight * (x - q) * (x - q) + f[q];
+      source[x] = q;
+    }
+  }
+  
+protected:
+  std::vector<int> vertices;
+  std::vector<float> boundaries;
+};
+
+}
+
+void DistanceField::bake(const std::vector<ofPolyline> & lines, ofFloatPixels & pixels, const Settings & settings)
+{
+  const int width = pixels.getWidth();
+  const int height = pixels.getHeight();
+  const int channels = pixels.getNumChannels();
+  float * data = pixels.getData();
+  
+  if (width == 0 || height == 0 || data == nullptr)
+  {
+    ofLogWarning("DistanceField::bake") << "pixels need to be allocated";
+    return;
+  }
+  
+  const ofRectangle bounds = (settings.bounds.width > 0 && settings.bounds.height > 0) ? settings.bounds : ofRectangle(0, 0, width, height);
+  const glm::vec2 pixelSize { bounds.width / width, bounds.height / height };
+  const glm::vec2 origin = glm::vec2(bounds.x, bounds.y) + pixelSize * 0.5f; // center of pixel (0, 0)
+  
+  std::vector<Segment> segments;
+  std::vector<ofPolyline> closed;
+  
+  for (const auto & line : lines)
+  {
+    const auto & vertices = line.getVertices();
+    const bool isClosed = line.isClosed() && vertices.size() > 2;
+    const size_t numSegments = (isClosed) ? vertices.size() : (vertices.size() > 1) ? vertices.size() - 1 : 0;
+    
+    for (size_t i = 0; i < numSegments; i++)
+    {
+      const glm::vec2 a = vertices[i];
+      const glm::vec2 ab = glm::vec2(vertices[(i + 1) % vertices.size()]) - a;
+      const float length2 = glm::dot(ab, ab);
+      segments.push_back({ a, ab, (length2 > 0.0f) ? 1.0f / length2 : 0.0f });
+    }
+    
+    if (isClosed) closed.push_back(line);
+  }
+  
+  const size_t len = (size_t) width * height;
+  
+  // Seeds: squared distance to, and index of, the nearest segment, FLT_MAX elsewhere
+  std::vector<float> seedDistance(len, std::numeric_limits<float>::max());
+  std::vector<int> seedSegment(len, -1);
+  
+  // Exact band: every segment visits the pixels of each row it passes within `band` of.
+  // A row of pixels only ever belongs to one chunk, so chunks write without locks.
+  const float band = MAX(settings.exactBand, 1.0f) * MAX(pixelSize.x, pixelSize.y);
+  
+  utils::Parallel::forRange(height, [&](size_t begin, size_t end) {
+    for (unsigned int s = 0; s < segments.size(); s++)
+    {
+      const Segment & segment = segments[s];
+      
+      const float minY = MIN(segment.a.y, segment.a.y + segment.ab.y) - band;
+      const float maxY = MAX(segment.a.y, segment.a.y + segment.ab.y) + band;
+      const int rowStart = MAX((int) ceil((minY - origin.y) / pixelSize.y), (int) begin);
+      const int rowEnd = MIN((int) floor((maxY - origin.y) / pixelSize.y), (int) end - 1);
+      
+      for (int y = rowStart; y <= rowEnd; y++)
+      {
+        // Part of the segment within `band` of the row, widened by `band`
+        const float rowY = origin.y + y * pixelSize.y;
+        float t0 = 0.0f, t1 = 1.0f;
+        if (segment.ab.y != 0.0f)
+        {
+          t0 = (rowY - band - segment.a.y) / segment.ab.y;
+          t1 = (rowY + band - segment.a.y) / segment.ab.y;
+          if (t0 > t1) std::swap(t0, t1);
+          t0 = MAX(t0, 0.0f);
+          t1 = MIN(t1, 1.0f);
+          if (t0 > t1) continue;
+        }
+        
+        const float x0 = segment.a.x + segment.ab.x * t0;
+        const float x1 = segment.a.x + segment.ab.x * t1;
+        const int columnStart = MAX((int) ceil((MIN(x0, x1) - band - origin.x) / pixelSize.x), 0);
+        const int columnEnd = MIN((int) floor((MAX(x0, x1) + band - origin.x) / pixelSize.x), width - 1);
+        
+        for (int x = columnStart; x <= columnEnd; x++)
+        {
+          const size_t i = (size_t) y * width + x;
+          const float distance = getDistance2(segment, origin + glm::vec2(x, y) * pixelSize);
+          if (distance < seedDistance[i] && distance <= band * band) { seedDistance[i] = distance; seedSegment[i] = s; }
+        }
+      }
+    }
+  });
+  
+  // Column scan: the closest seed row above or below and its segment, per pixel
+  std::vector<int> seedRow(len, -1);
+  std::vector<int> columnSegment(len, -1);
+  
+  utils::Parallel::forRange(width, [&](size_t begin, size_t end) {
+    for (int y = 0; y < height; y++)
+    {
+      for (size_t x = begin; x < end; x++)
+      {
+        const size_t i = (size_t) y * width + x;
+        if (seedSegment[i] >= 0) { seedRow[i] = y; columnSegment[i] = seedSegment[i]; }
+        else if (y > 0) { seedRow[i] = seedRow[i - width]; columnSegment[i] = columnSegment[i - width]; }
+      }
+    }
+    
+    for (int y = height - 2; y >= 0; y--)
+    {
+      for (size_t x = begin; x < end; x++)
+      {
+        const size_t i = (size_t) y * width + x;
+        const int below = seedRow[i + width];
+        if (below >= 0 && (seedRow[i] < 0 || below - y < y - seedRow[i])) { seedRow[i] = below; columnSegment[i] = columnSegment[i + width]; }
+      }
+    }
+  }, 64);
+  
+  // Segments reaching outside the pixels leave no seeds there, so pixels closer to the border
+  // than to their seed also look them up in a BVH
+  std::vector<ofPolyline> outside;
+  
+  for (unsigned int s = 0; s < segments.size(); s++)
+  {
+    const glm::vec2 a = segments[s].a;
+    const glm::vec2 b = a + segments[s].ab;
+    if (bounds.inside(a.x, a.y) && bounds.inside(b.x, b.y)) continue;
+    
+    outside.emplace_back();
+    outside.back().addVertex(glm::vec3(a, 0.0f));
+    outside.back().addVertex(glm::vec3(b, 0.0f));
+  }
+  
+  const spatial::SegmentBVH bvh(outside);
+  
+  // Inside / outside: crossings of every row with the closed lines, in x order
+  std::vector<unsigned int> crossingStart(height + 1, 0);
+  std::vector<float> crossings;
+  
+  if (!closed.empty())
+  {
+    int filled = 0;
+    auto fillTo = [&](int row) { while (filled <= row) crossingStart[filled++] = crossings.size(); };
+    
+    const spatial::ScanlineSweep sweep(closed);
+    sweep.sweep(origin.y, pixelSize.y, [&](int row, float, const std::vector<spatial::ScanlineSweep::Crossing> & active) {
+      if (row >= height) return;
+      
+      fillTo(row);
+      for (const auto & crossing : active) crossings.push_back(crossing.x);
+    });
+    fillTo(height);
+  }
+  
+  // Row pass: the parabola lower envelope over the column results finds the closest seed,
+  // which is then measured exactly against its segment
+  const float weightX = pixelSize.x * pixelSize.x;
+  const float weightY = pixelSize.y * pixelSize.y;
+  const float maxDistance = (settings.maxDistance > 0.0f) ? settings.maxDistance : std::numeric_limits<float>::max();
+  
+  utils::Parallel::forRange(height, [&](size_t begin, size_t end) {
+    Envelope envelope(width);
+    std::vector<float> f(width), output(width);
+    std::vector<int> source(width);
+    
+    for (size_t y = begin; y < end; y++)
+    {
+      const size_t row = y * width;
+      
+      for (int x = 0; x < width; x++)
+      {
+        const int dy = (int) y - seedRow[row + x];
+        f[x] = (seedRow[row + x] >= 0) ? weightY * dy * dy : std::numeric_limits<float>::max();
+      }
+      envelope.transform(f.data(), width, weightX, output.data(), source.data());
+      
+      const unsigned int * crossing = (closed.empty()) ? nullptr : &crossingStart[y];
+      unsigned int next = (crossing) ? crossing[0] : 0;
+      bool inside = false;
+      
+      for (int x = 0; x < width; x++)
+      {
+        const glm::vec2 p = origin + glm::vec2(x, y) * pixelSize;
+        
+        float distance = std::numeric_limits<float>::max();
+        if (seedSegment[row + x] >= 0) distance = sqrt(seedDistance[row + x]);
+        else if (source[x] >= 0)
+        {
+          distance = sqrt(getDistance2(segments[columnSegment[row + source[x]]], p));
+        }
+        
+        if (!outside.empty())
+        {
+          const float border = MIN(MIN(p.x - bounds.x, bounds.x + bounds.width - p.x), MIN(p.y - bounds.y, bounds.y + bounds.height - p.y));
+          if (distance > border)
+          {
+            const auto nearest = bvh.getClosest(p, distance);
+            if (nearest.found()) distance = MIN(distance, nearest.distance);
+          }
+        }
+        
+        if (crossing) while (next < crossing[1] && crossings[next] < p.x) { inside = !inside; next++; }
+        
+        const float value = CLAMP((inside) ? -distance : distance, -maxDistance, maxDistance);
+        for (int c = 0; c < channels; c++) data[(row + x) * channels + c] = value;
+      }
+    }
+  }, 16);
+}
+
+ofFloatPixels DistanceField::getDistanceField(const std::vector<ofPolyline> & lines, int width, int height, const Settings & settings)
+{
+  ofFloatPixels pixels;
+  pixels.allocate(width, height, OF_IMAGE_GRAYSCALE);
+  bake(lines, pixels, settings);
+  return pixels;
+}
+
+}}}
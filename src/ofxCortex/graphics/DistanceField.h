@@ -0,0 +1,38 @@
+#pragma once
+
+#include "ofPath.h"
+#include "ofPixels.h"
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Signed distance fields of polylines baked on the CPU into ofFloatPixels.
+// Pixels within `exactBand` of an edge get the exact distance; every other
+// pixel finds its nearest band pixel through a separable distance transform
+// (a column scan, then the parabola lower envelope along rows) and measures
+// the exact distance to that pixel's segment. Distances are negative inside
+// the closed lines (even-odd) and positive outside, open lines only add
+// distance. Rows are spread over utils::Parallel's shared pool.
+//
+//   ofFloatPixels field;
+//   field.allocate(ofGetWidth(), ofGetHeight(), OF_IMAGE_GRAYSCALE);
+//   DistanceField::bake(Typography::getStringAsLines(font, "glow", pos, 200), field);
+class DistanceField {
+public:
+  struct Settings {
+    ofRectangle bounds; // area covered by the pixels, empty maps one unit to one pixel
+    float exactBand { 2.0f }; // in pixels
+    float maxDistance { 0.0f }; // clamps the output to [-maxDistance, maxDistance], 0 leaves it unbounded
+  };
+  
+  // Writes every channel of the already allocated `pixels`
+  static void bake(const std::vector<ofPolyline> & lines, ofFloatPixels & pixels, const Settings & settings);
+  static void bake(const std::vector<ofPolyline> & lines, ofFloatPixels & pixels) { bake(lines, pixels, Settings()); }
+  static void bake(const ofPolyline & line, ofFloatPixels & pixels, const Settings & settings) { bake(std::vector<ofPolyline>{ line }, pixels, settings); }
+  static void bake(const ofPath & path, ofFloatPixels & pixels, const Settings & settings) { bake(path.getOutline(), pixels, settings); }
+  
+  // Single channel field of `width` x `height` pixels
+  static ofFloatPixels getDistanceField(const std::vector<ofPolyline> & lines, int width, int height, const Settings & settings);
+};
+
+}}}
@@ -0,0 +1,306 @@
+#include "IsoContours.h"
+
+#include <numeric>
+#include <unordered_map>
+
+#include "ofLog.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+namespace {
+
+// Crossing from one grid edge to another inside a cell, with the values above the level
+// on the same side of every segment, so a crossing is the end of exactly one segment and
+// the start of the one in the next cell
+struct Segment {
+  unsigned int from;
+  unsigned int to;
+};
+
+// A run of joined segments; `head` and `tail` are global edge ids
+struct Chain {
+  std::vector<glm::vec2> points;
+  size_t head;
+  size_t tail;
+  bool closed;
+};
+
+// Edges of a grid of samples: horizontal edge (x, y) joins samples (x, y) and (x + 1, y),
+// vertical edge (x, y) joins (x, y) and (x, y + 1). Horizontal edges come first, row by row.
+class Grid {
+public:
+  Grid(const float * values, int width, int height, size_t stride) : values(values), width(width), height(height), stride(stride), numHorizontal((size_t) (width - 1) * height) {}
+  
+  float get(int x, int y) const { return values[((size_t) y * width + x) * stride]; }
+  
+  size_t getHorizontal(int x, int y) const { return (size_t) y * (width - 1) + x; }
+  size_t getVertical(int x, int y) const { return numHorizontal + (size_t) y * width + x; }
+  
+  // Where the edge crosses `level`, in samples. Always interpolated from the same end, so both
+  // cells sharing an edge get the same point.
+  glm::vec2 getCrossing(size_t edge, float level) const
+  {
+    if (edge < numHorizontal)
+    {
+      const int x = edge % (width - 1), y = edge / (width - 1);
+      const float a = get(x, y), b = get(x + 1, y);
+      return { x + (level - a) / (b - a), y };
+    }
+    
+    edge -= numHorizontal;
+    const int x = edge % width, y = edge / width;
+    const float a = get(x, y), b = get(x, y + 1);
+    return { x, y + (level - a) / (b - a) };
+  }
+  
+  const float * values;
+  const int width;
+  const int height;
+  const size_t stride;
+  const size_t numHorizontal;
+};
+
+// Cells of rows [rowStart, rowEnd), with the edges they touch numbered locally
+class Band {
+public:
+  Band(const Grid & grid, int rowStart, int rowEnd) : grid(grid), rowStart(rowStart), rowEnd(rowEnd),
+    numHorizontal((size_t) (grid.width - 1) * (rowEnd - rowStart + 1)),
+    startAt(numHorizontal + (size_t) grid.width * (rowEnd - rowStart), -1),
+    endAt(startAt.size(), -1) {}
+  
+  void march(const std::vector<unsigned int> & order, const std::vector<float> & sorted, bool resolveSaddles, std::vector<std::vector<Segment>> & segments) const
+  {
+    const int width = grid.width;
+    const size_t rowH = width - 1;
+    
+    for (int y = rowStart; y < rowEnd; y++)
+    {
+      const size_t top = (size_t) (y - rowStart) * rowH;
+      const size_t bottom = top + rowH;
+      const size_t left = numHorizontal + (size_t) (y - rowStart) * width;
+      
+      for (int x = 0; x < width - 1; x++)
+      {
+        // Corners clockwise from the top left, edge k runs from corner k to corner k + 1
+        const float v[4] = { grid.get(x, y), grid.get(x + 1, y), grid.get(x + 1, y + 1), grid.get(x, y + 1) };
+        const unsigned int edges[4] = { (unsigned int) (top + x), (unsigned int) (left + x + 1), (unsigned int) (bottom + x), (unsigned int) (left + x) };
+        
+        const float lo = MIN(MIN(v[0], v[1]), MIN(v[2], v[3]));
+        const float hi = MAX(MAX(v[0], v[1]), MAX(v[2], v[3]));
+        
+        // Only the levels in [lo, hi) cross the cell
+        for (size_t l = std::lower_bound(sorted.begin(), sorted.end(), lo) - sorted.begin(); l < sorted.size() && sorted[l] < hi; l++)
+        {
+          const float level = sorted[l];
+          const bool above[4] = { v[0] > level, v[1] > level, v[2] > level, v[3] > level };
+          auto & output = segments[order[l]];
+          
+          if (above[0] == above[2] && above[1] == above[3] && above[0] != above[1])
+          {
+            // Saddle: either the corners above the level connect through the middle, and the
+            // segments cut off the corners below, or they are kept apart
+            bool connected = false;
+            if (resolveSaddles)
+            {
+              const float denominator = v[0] + v[2] - v[1] - v[3];
+              const float center = (denominator != 0.0f) ? (v[0] * v[2] - v[1] * v[3]) / denominator : (v[0] + v[1] + v[2] + v[3]) * 0.25f;
+              connected = center > level;
+            }
+            
+            for (int k = 0; k < 4; k++)
+            {
+              if (!above[k] || above[(k + 1) % 4]) continue;
+              output.push_back({ edges[k], edges[(connected) ? (k + 1) % 4 : (k + 3) % 4] });
+            }
+            continue;
+          }
+          
+          int from = -1, to = -1;
+          for (int k = 0; k < 4; k++)
+          {
+            if (above[k] && !above[(k + 1) % 4]) from = k;
+            else if (!above[k] && above[(k + 1) % 4]) to = k;
+          }
+          if (from >= 0 && to >= 0) output.push_back({ edges[from], edges[to] }); // NaN corners leave no segment
+        }
+      }
+    }
+  }
+  
+  // Joins the segments of one level into chains, closed loops are finished here
+  void trace(const std::vector<Segment> & segments, float level, std::vector<Chain> & chains)
+  {
+    for (int i = 0; i < (int) segments.size(); i++)
+    {
+      startAt[segments[i].from] = i;
+      endAt[segments[i].to] = i;
+    }
+    
+    std::vector<bool> visited(segments.size(), false);
+    
+    auto follow = [&](int first, bool closed) {
+      chains.emplace_back();
+      Chain & chain = chains.back();
+      chain.closed = closed;
+      chain.head = toGlobal(segments[first].from);
+      
+      int i = first;
+      int last = first;
+      do {
+        visited[i] = true;
+        chain.points.push_back(grid.getCrossing(toGlobal(segments[i].from), level));
+        last = i;
+        i = startAt[segments[i].to];
+      } while (i >= 0 && i != first);
+      
+      chain.tail = toGlobal(segments[last].to);
+      if (!closed) chain.points.push_back(grid.getCrossing(chain.tail, level));
+    };
+    
+    // Chains starting on the border of the band first, whatever is left is a loop
+    for (int i = 0; i < (int) segments.size(); i++) if (endAt[segments[i].from] < 0) follow(i, false);
+    for (int i = 0; i < (int) segments.size(); i++) if (!visited[i]) follow(i, true);
+    
+    for (const auto & segment : segments) { startAt[segment.from] = -1; endAt[segment.to] = -1; }
+  }
+
+protected:
+  const Grid & grid;
+  const int rowStart;
+  const int rowEnd;
+  const size_t numHorizontal;
+  std::vector<int> startAt; // segment starting at each local edge, or -1
+  std::vector<int> endAt;
+  
+  size_t toGlobal(unsigned int edge) const
+  {
+    if (edge < numHorizontal) return grid.getHorizontal(0, rowStart) + edge;
+    return grid.getVertical(0, rowStart) + (edge - numHorizontal);
+  }
+};
+
+// Stitches the open chains of every band through the edges they end on
+void stitch(std::vector<Chain> & chains, std::vector<ofPolyline> & output, const glm::vec2 & origin, const glm::vec2 & sampleSize)
+{
+  std::unordered_map<size_t, size_t> heads;
+  for (size_t i = 0; i < chains.size(); i++) if (!chains[i].closed) heads[chains[i].head] = i;
+  
+  std::vector<int> next(chains.size(), -1);
+  std::vector<bool> hasPrevious(chains.size(), false);
+  for (size_t i = 0; i < chains.size(); i++)
+  {
+    if (chains[i].closed) continue;
+    
+    const auto found = heads.find(chains[i].tail);
+    if (found == heads.end()) continue;
+    
+    next[i] = found->second;
+    hasPrevious[found->second] = true;
+  }
+  
+  std::vector<bool> used(chains.size(), false);
+  auto emit = [&](size_t first) {
+    output.emplace_back();
+    ofPolyline & line = output.back();
+    
+    int i = first;
+    do {
+      used[i] = true;
+      
+      // The tail of a chain is the head of the next one
+      const auto & points = chains[i].points;
+      const size_t count = (next[i] >= 0) ? points.size() - 1 : points.size();
+      for (size_t k = 0; k < count; k++) line.addVertex(glm::vec3(origin + points[k] * sampleSize, 0.0f));
+      
+      i = next[i];
+    } while (i >= 0 && !used[i]);
+    
+    if (chains[first].closed || i == (int) first) line.close();
+  };
+  
+  // Lines starting on the border of the field (or closed within a band) first, what is left
+  // are loops running through several bands
+  for (size_t i = 0; i < chains.size(); i++) if (!hasPrevious[i]) emit(i);
+  for (size_t i = 0; i < chains.size(); i++) if (!used[i]) emit(i);
+}
+
+}
+
+std::vector<std::vector<ofPolyline>> IsoContours::getContours(const ofFloatPixels & field, const std::vector<float> & levels, const Settings & settings)
+{
+  if (field.getWidth() == 0 || field.getHeight() == 0 || field.getData() == nullptr)
+  {
+    ofLogWarning("IsoContours::getContours") << "pixels need to be allocated";
+    return std::vector<std::vector<ofPolyline>>(levels.size());
+  }
+  
+  return getContours(field.getData(), field.getWidth(), field.getHeight(), field.getNumChannels(), levels, settings);
+}
+
+std::vector<std::vector<ofPolyline>> IsoContours::getContours(const std::function<float(const glm::vec2 &)> & sample, int columns, int rows, const std::vector<float> & levels, const Settings & settings)
+{
+  if (columns <= 0 || rows <= 0) return std::vector<std::vector<ofPolyline>>(levels.size());
+  
+  const ofRectangle bounds = (settings.bounds.width > 0 && settings.bounds.height > 0) ? settings.bounds : ofRectangle(0, 0, columns, rows);
+  const glm::vec2 sampleSize { bounds.width / columns, bounds.height / rows };
+  const glm::vec2 origin = glm::vec2(bounds.x, bounds.y) + sampleSize * 0.5f;
+  
+  std::vector<float> values((size_t) columns * rows);
+  utils::Parallel::forRange(rows, [&](size_t begin, size_t end) {
+    for (size_t y = begin; y < end; y++)
+    {
+      for (int x = 0; x < columns; x++) values[y * columns + x] = sample(origin + glm::vec2(x, y) * sampleSize);
+    }
+  }, 4);
+  
+  Settings traced = settings;
+  traced.bounds = bounds;
+  return getContours(values.data(), columns, rows, 1, levels, traced);
+}
+
+std::vector<std::vector<ofPolyline>> IsoContours::getContours(const float * values, int width, int height, size_t stride, const std::vector<float> & levels, const Settings & settings)
+{
+  std::vector<std::vector<ofPolyline>> output(levels.size());
+  if (width < 2 || height < 2 || levels.empty()) return output;
+  
+  const ofRectangle bounds = (settings.bounds.width > 0 && settings.bounds.height > 0) ? settings.bounds : ofRectangle(0, 0, width, height);
+  const glm::vec2 sampleSize { bounds.width / width, bounds.height / height };
+  const glm::vec2 origin = glm::vec2(bounds.x, bounds.y) + sampleSize * 0.5f;
+  
+  // Levels sorted once, so each cell only visits the levels between its lowest and highest corner
+  std::vector<unsigned int> order(levels.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&levels](unsigned int a, unsigned int b) { return levels[a] < levels[b]; });
+  
+  std::vector<float> sorted(levels.size());
+  for (size_t l = 0; l < levels.size(); l++) sorted[l] = levels[order[l]];
+  
+  // A few bands per thread to even out the load
+  const Grid grid(values, width, height, stride);
+  const int cellRows = height - 1;
+  const int numBands = CLAMP((int) utils::Parallel::ThreadPool::shared().getConcurrency() * 4, 1, MAX(cellRows / 8, 1));
+  
+  std::vector<std::vector<std::vector<Chain>>> chains(numBands, std::vector<std::vector<Chain>>(levels.size()));
+  
+  utils::Parallel::forEach(numBands, [&](size_t b) {
+    const int rowStart = (int) ((size_t) cellRows * b / numBands);
+    const int rowEnd = (int) ((size_t) cellRows * (b + 1) / numBands);
+    
+    Band band(grid, rowStart, rowEnd);
+    std::vector<std::vector<Segment>> segments(levels.size());
+    band.march(order, sorted, settings.resolveSaddles, segments);
+    
+    for (size_t l = 0; l < levels.size(); l++) band.trace(segments[l], levels[l], chains[b][l]);
+  });
+  
+  utils::Parallel::forEach(levels.size(), [&](size_t l) {
+    std::vector<Chain> level;
+    for (auto & band : chains) std::move(band[l].begin(), band[l].end(), std::back_inserter(level));
+    stitch(level, output[l], origin, sampleSize);
+  });
+  
+  return output;
+}
+
+}}}
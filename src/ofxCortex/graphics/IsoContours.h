@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Iso-lines of a sampled field with marching squares, joined into polylines.
+// All levels are traced in the same pass over the samples, in bands of rows
+// spread over utils::Parallel's pool; lines crossing a band boundary are
+// stitched back together through the grid edge they cross. Lines that leave
+// the field stay open, the others are closed, and every line keeps the values
+// above its level on the same side.
+//
+// Saddle cells (two opposite corners above the level) are ambiguous; by default
+// the bilinear interpolant decides which corners connect (the asymptotic
+// decider), otherwise the corners above the level are always kept apart.
+//
+//   ofFloatPixels noise = ...; // PerlinNoise written per pixel, or a DistanceField
+//   auto lines = IsoContours::getContours(noise, { 0.25f, 0.5f, 0.75f });
+//   for (const auto & line : lines[1]) line.draw();
+class IsoContours {
+public:
+  struct Settings {
+    ofRectangle bounds; // area covered by the samples, empty maps one sample to one unit
+    bool resolveSaddles { true };
+  };
+  
+  // One vector of lines per level, in the order of `levels`. Reads the first channel.
+  static std::vector<std::vector<ofPolyline>> getContours(const ofFloatPixels & field, const std::vector<float> & levels, const Settings & settings);
+  static std::vector<std::vector<ofPolyline>> getContours(const ofFloatPixels & field, const std::vector<float> & levels) { return getContours(field, levels, Settings()); }
+  static std::vector<ofPolyline> getContours(const ofFloatPixels & field, float level, const Settings & settings) { return getContours(field, std::vector<float>{ level }, settings).front(); }
+  
+  // Samples `sample` at the centres of a `columns` x `rows` grid over `settings.bounds` (in
+  // parallel) and traces the result. An empty `bounds` covers [0, columns] x [0, rows].
+  static std::vector<std::vector<ofPolyline>> getContours(const std::function<float(const glm::vec2 &)> & sample, int columns, int rows, const std::vector<float> & levels, const Settings & settings);
+  
+  // `values` is `width` x `height` samples, `stride` floats apart
+  static std::vector<std::vector<ofPolyline>> getContours(const float * values, int width, int height, size_t stride, const std::vector<float> & levels, const Settings & settings);
+};
+
+}}}
@@ -1,10 +1,15 @@
 #include "Line.h"
+#include "OffsetShape.h"
+#include "PolylineMorph.h"
+#include "MeasuredPolyline.h"
+#include "ofxCortex/generators/Noise.h"
+#include <queue>
 
 namespace ofxCortex { namespace core { namespace graphics {
 
 ofPath Line::getLinePath(const ofPolyline & source, float thickness, ClipperLib::JoinType jointype, ClipperLib::EndType endtype)
 {
-  return polysToPath(Clipper::getOffsets({ source }, thickness, jointype, endtype));
+  return polysToPath(*OffsetShape::getCached({ source }, jointype, endtype)->getOffset(thickness));
 }
 
 void Line::drawPolyline(const ofPolyline & source, float thickness, ofFloatColor color, ClipperLib::JoinType jointype, ClipperLib::EndType endtype)
@@ -19,11 +24,41 @@ void Line::drawPolyline(const ofPolyline & source, float thickness, ofFloatColor
     return;
   }
   
-  ofPath path = polysToPath(Clipper::getOffsets({ source }, thickness, jointype, endtype));
+  ofPath path = polysToPath(*OffsetShape::getCached({ source }, jointype, endtype)->getOffset(thickness));
   path.setFillColor(color);
   path.draw();
 }
 
+template<typename Pass>
+void Line::pingPong(const ofPolyline & source, ofPolyline & output, int iterations, size_t finalSize, Pass && pass)
+{
+  // The second buffer lives on between calls, so repeated smoothing does not allocate
+  static thread_local std::vector<glm::vec3> scratch;
+  std::vector<glm::vec3> & result = output.getVertices();
+  
+  result.reserve(finalSize + 1);
+  scratch.reserve(finalSize + 1);
+  
+  // Buffers alternate backwards from the last pass, which always writes into `result`
+  const bool firstIntoResult = iterations % 2 == 1;
+  const std::vector<glm::vec3> * input = &source.getVertices();
+  
+  if (input == &result && firstIntoResult)
+  {
+    scratch.assign(result.begin(), result.end());
+    input = &scratch;
+  }
+  
+  for (int i = 0; i < iterations; i++)
+  {
+    std::vector<glm::vec3> & target = ((iterations - i) % 2 == 1) ? result : scratch;
+    pass(*input, target);
+    input = &target;
+  }
+  
+  output.flagHasChanged();
+}
+
 void Line::catmullRom(ofPolyline & source, int iterations)
 {
   if (source.size() < 3) {
@@ -33,27 +68,116 @@ void Line::catmullRom(ofPolyline & source, int iterations)
   
   iterations = std::max(1, iterations);
   
-  std::vector<glm::vec3> points = source.getVertices();
-  
-  glm::vec3 extrapolated = points[1] - points[0];
-  points.insert(points.begin(), points[0] - extrapolated);
-  
-  extrapolated = points[points.size() - 1] - points[points.size() - 2];
-  points.insert(points.end(), points[points.size() - 1] + extrapolated);
+  const std::vector<glm::vec3> & points = source.getVertices();
+  const size_t numSegments = points.size() - 1;
   
   std::vector<glm::vec3> spline;
-  for (int i = 0; i < points.size() - 3; i++)
+  spline.reserve(numSegments * iterations + 1);
+  
+  glm::vec3 controls[4];
+  for (size_t i = 0; i < numSegments; i++)
   {
+    getCatmullRomControls(points, false, i, controls);
     for (int p = 0; p < iterations; p++)
     {
-      spline.push_back(glm::catmullRom(points[i], points[i+1], points[i+2], points[i+3], p / (float) iterations));
+      spline.push_back(glm::catmullRom(controls[0], controls[1], controls[2], controls[3], p / (float) iterations));
     }
   }
-  spline.push_back(points[points.size() - 2]);
+  spline.push_back(points.back());
   
   source = ofPolyline(spline);
 }
 
+void Line::getCatmullRomControls(const std::vector<glm::vec3> & points, bool closed, size_t segment, glm::vec3 * controls)
+{
+  const size_t len = points.size();
+  
+  controls[1] = points[segment];
+  controls[2] = points[(segment + 1) % len];
+  
+  // Open ends get a phantom point mirrored from the neighbouring segment
+  if (closed || segment > 0) controls[0] = points[(segment + len - 1) % len];
+  else controls[0] = 2.0f * controls[1] - controls[2];
+  
+  if (closed || segment + 2 < len) controls[3] = points[(segment + 2) % len];
+  else controls[3] = 2.0f * controls[2] - controls[1];
+}
+
+void Line::adaptiveCatmullRom(const ofPolyline & source, ofPolyline & output, float tolerance, float alpha, int maxSteps)
+{
+  if (source.size() < 2) {
+    if (&output != &source) output = source;
+    return;
+  }
+  
+  // Reading and writing the same polyline, the input has to be kept aside first
+  static thread_local std::vector<glm::vec3> copy;
+  const std::vector<glm::vec3> * input = &source.getVertices();
+  if (&output == &source) { copy.assign(input->begin(), input->end()); input = &copy; }
+  
+  const std::vector<glm::vec3> & points = *input;
+  const bool closed = source.isClosed() && points.size() > 2;
+  const size_t numSegments = (closed) ? points.size() : points.size() - 1;
+  
+  maxSteps = MAX(maxSteps, 1);
+  tolerance = MAX(tolerance, 1e-6f);
+  
+  std::vector<glm::vec3> & result = output.getVertices();
+  result.clear();
+  result.push_back(points[0]);
+  
+  glm::vec3 controls[4];
+  for (size_t segment = 0; segment < numSegments; segment++)
+  {
+    getCatmullRomControls(points, closed, segment, controls);
+    
+    // Non-uniform knots: alpha = 0 is uniform, 0.5 centripetal (no cusps or self-intersections), 1 chordal
+    auto knot = [alpha](const glm::vec3 & a, const glm::vec3 & b) {
+      const float d = pow(glm::length2(b - a), alpha * 0.5f);
+      return (d < 1e-4f) ? 1.0f : d;
+    };
+    
+    const float d0 = knot(controls[0], controls[1]);
+    const float d1 = knot(controls[1], controls[2]);
+    const float d2 = knot(controls[2], controls[3]);
+    
+    // Tangents at p1 and p2 of the Barry-Goldman curve, rescaled to the [0, 1] segment parameter
+    const glm::vec3 m1 = ((controls[1] - controls[0]) / d0 - (controls[2] - controls[0]) / (d0 + d1) + (controls[2] - controls[1]) / d1) * d1;
+    const glm::vec3 m2 = ((controls[2] - controls[1]) / d1 - (controls[3] - controls[1]) / (d1 + d2) + (controls[3] - controls[2]) / d2) * d1;
+    
+    // Hermite segment as a cubic polynomial: a t^3 + b t^2 + c t + d
+    const glm::vec3 & p1 = controls[1];
+    const glm::vec3 & p2 = controls[2];
+    const glm::vec3 a = 2.0f * (p1 - p2) + m1 + m2;
+    const glm::vec3 b = 3.0f * (p2 - p1) - 2.0f * m1 - m2;
+    
+    // Sampling a curve in n even steps strays at most max|f''| / (8 n^2) from it, and the
+    // second derivative of a cubic is linear, so its maximum sits at one of the ends
+    const float curvature = sqrt(MAX(glm::length2(2.0f * b), glm::length2(6.0f * a + 2.0f * b)));
+    const int steps = CLAMP((int) ceil(sqrt(curvature / (8.0f * tolerance))), 1, maxSteps);
+    
+    for (int step = 1; step < steps; step++)
+    {
+      const float t = step / (float) steps;
+      result.push_back(((a * t + b) * t + m1) * t + p1);
+    }
+    result.push_back(p2);
+  }
+  
+  // The last segment of a closed line ends back on the first vertex
+  if (closed) result.pop_back();
+  
+  output.setClosed(closed);
+  output.flagHasChanged();
+}
+
+ofPolyline Line::getAdaptiveCatmullRom(const ofPolyline & source, float tolerance, float alpha, int maxSteps)
+{
+  ofPolyline output;
+  adaptiveCatmullRom(source, output, tolerance, alpha, maxSteps);
+  return output;
+}
+
 ofPolyline Line::getCatmullRom(const ofPolyline & source, int iterations)
 {
   ofPolyline output = source;
@@ -61,10 +185,11 @@ ofPolyline Line::getCatmullRom(const ofPolyline & source, int iterations)
   return output;
 }
 
-void Line::chaikin(ofPolyline & source, int iterations, float tension)
+void Line::chaikin(const ofPolyline & source, ofPolyline & output, int iterations, float tension)
 {
   if (source.size() < 3) {
     ofLogNotice("Line::chaikin()") << "Source needs at least 3 vertices.";
+    if (&output != &source) output = source;
     return;
   }
   
@@ -73,37 +198,36 @@ void Line::chaikin(ofPolyline & source, int iterations, float tension)
   bool closed = source.isClosed();
   
   float cuttingDistance = 0.05f + (tension * 0.4f);
-  std::vector<glm::vec3> points = source.getVertices();
   
-  auto getSmoothedPoints = [](const std::vector<glm::vec3> &points, float cuttingDistance, bool closed) -> std::vector<glm::vec3>
+  // Every pass doubles the vertex count, open or closed
+  auto smooth = [cuttingDistance, closed](const std::vector<glm::vec3> & points, std::vector<glm::vec3> & smoothed)
   {
-    if (points.size() < 3) return points;
-    std::vector<glm::vec3> output;
-    size_t numPoints = (closed) ? points.size(): points.size() - 1;
+    const size_t len = points.size();
+    smoothed.resize(len * 2);
     
+    glm::vec3 * out = smoothed.data();
+    if (!closed) *out++ = points[0];
     
-    if (!closed) output.push_back(points[0]);
-    
-    for (int i = 0; i < numPoints; i++)
+    for (size_t i = 0, numPoints = (closed) ? len : len - 1; i < numPoints; i++)
     {
-      output.push_back((1.0f - cuttingDistance) * points[i % points.size()] + cuttingDistance * points[(i + 1) % points.size()]);
-      output.push_back(cuttingDistance * points[i % points.size()] + (1.0f - cuttingDistance) * points[(i + 1) % points.size()]);
+      const glm::vec3 & current = points[i];
+      const glm::vec3 & next = points[(i + 1 < len) ? i + 1 : 0];
+      
+      *out++ = (1.0f - cuttingDistance) * current + cuttingDistance * next;
+      *out++ = cuttingDistance * current + (1.0f - cuttingDistance) * next;
     }
     
-    if (!closed) output.push_back(points[points.size() - 1]);
-    
-    return output;
+    if (!closed) *out++ = points[len - 1];
   };
   
-  for (int i = 0; i < iterations; i++) { points = getSmoothedPoints(points, cuttingDistance, closed); }
-  
-  source = ofPolyline(points);
+  pingPong(source, output, iterations, getChaikinSize(source.size(), iterations), smooth);
+  output.setClosed(false);
 }
 
 ofPolyline Line::getChaikin(const ofPolyline & source, int iterations, float tension)
 {
-  ofPolyline output = source;
-  chaikin(output, iterations, tension);
+  ofPolyline output;
+  chaikin(source, output, iterations, tension);
   return output;
 }
 
@@ -258,40 +382,26 @@ ofPath Line::polysToPath(const std::vector<ofPolyline> & polylines) {
 std::vector<ofPolyline> Line::getOffsets(const ofPolyline & source, std::vector<float> offsets, ClipperLib::JoinType jointype,
                                      ClipperLib::EndType endtype)
 {
-  std::vector<ofPolyline> output;
-  
-  if (source.size() == 0) return output;
-  
-  for (float offset : offsets)
-  {
-    auto lines = Clipper::getOffsets({ source }, offset, jointype, endtype);
-    output.insert(output.end(), lines.begin(), lines.end());
-  }
+  if (source.size() == 0) return std::vector<ofPolyline>();
   
-  return output;
+  return getOffsets(std::vector<ofPolyline>{ source }, offsets, jointype, endtype);
 }
 
 std::vector<ofPolyline> Line::getOffsets(const std::vector<ofPolyline> & sources, std::vector<float> offsets, ClipperLib::JoinType jointype,
                                      ClipperLib::EndType endtype)
 {
-  std::vector<ofPolyline> output;
-  
   if (sources.size() == 0) return sources;
+  if (offsets.size() == 1) return Clipper::getOffsets(sources, offsets[0], jointype, endtype);
   
-  for (float offset : offsets)
-  {
-    auto lines = Clipper::getOffsets(sources, offset, jointype, endtype);
-    output.insert(output.end(), lines.begin(), lines.end());
-  }
-  
-  return output;
+  // One-off: the sources are converted once for all offsets, without going through the shared cache
+  return OffsetShape(sources, jointype, endtype).getOffsets(offsets);
 }
 
 ofPolyline Line::getOffset(const ofPolyline & source, float offset, ClipperLib::JoinType jointype, ClipperLib::EndType endtype)
 {
   if (source.size() == 0) return source;
   
-  auto lines = getOffsets(source, std::vector<float>{ offset }, jointype, endtype);
+  auto lines = Clipper::getOffsets({ source }, offset, jointype, endtype);
   
   return (lines.size()) ? lines[0] : source;
 }
@@ -306,7 +416,7 @@ void Line::offset(ofPolyline & source, float offset, ClipperLib::JoinType jointy
 
 ofPolyline Line::getLineSubsection(const ofPolyline & source, float start, float end)
 {
-  if (source.size() == 0) return source;
+  if (source.size() < 2) return source;
   
   float actualStart = MIN(start, end);
   float actualEnd = MAX(start, end);
@@ -314,64 +424,122 @@ ofPolyline Line::getLineSubsection(const ofPolyline & source, float start, float
   if (ofIsFloatEqual(actualStart, actualEnd)) return ofPolyline();
   if (ofIsFloatEqual(actualStart, 0.0f) && ofIsFloatEqual(actualEnd, 1.0f)) return source;
   
+  // Both ends are located on the same measured lengths instead of two getIndexAtPercent walks.
+  // On closed lines start > end wraps through the first vertex, open lines are swapped.
+  return MeasuredPolyline(source).getSubsectionAtPercent(start, end);
+}
+
+
+ofPolyline Line::getInterpolatedPolyline(const ofPolyline & source, const ofPolyline & target, float t){
+  // Different vertex counts are matched up by arc length. Keep a PolylineMorph around when morphing every frame.
+  if (source.size() != target.size()) return PolylineMorph(source, target).getInterpolated(t);
+  
   ofPolyline output;
+  auto & vertices = output.getVertices();
+  vertices.resize(source.size());
   
-  float startIndex = source.getIndexAtPercent(actualStart);
-  int fillStartIndex = ceil(startIndex);
-  float endIndex = source.getIndexAtPercent(actualEnd);
-  int fillEndIndex = floor(endIndex) + 1;
+  for (size_t i = 0; i < source.size(); i++) vertices[i] = glm::mix(source[i], target[i], t);
+  return output;
+}
+
+void Line::scribbleLine(const ofPolyline & source, ofPolyline & output, float resolution, float amplitude)
+{
+  if (source.size() < 2) {
+    if (&output != &source) output = source;
+    return;
+  }
   
-  std::vector<glm::vec3> filler;
+  // Measuring copies the vertices, so `output` may alias `source` from here on
+  const MeasuredPolyline measured(source);
+  std::vector<glm::vec3> & vertices = output.getVertices();
   
-  if (source.isClosed() && start > end)
+  // Same spacing as ofPolyline::getResampledBySpacing, in one walk along the line
+  if (resolution > 0.0f)
   {
-    std::swap(startIndex, endIndex);
+    static thread_local std::vector<float> lengths;
+    
+    const float total = measured.getLength();
+    const size_t count = (size_t) (total / resolution) + 1;
     
-    std::copy(source.begin() + fillEndIndex, source.end(), back_inserter(filler));
-    std::copy(source.begin(), source.begin() + fillStartIndex, back_inserter(filler));
+    lengths.resize(count);
+    for (size_t i = 0; i < count; i++) lengths[i] = resolution * i;
+    if (!measured.isClosed() && lengths.back() < total) lengths.push_back(total);
+    if (measured.isClosed() && lengths.size() > 1 && lengths.back() >= total) lengths.pop_back();
+    
+    measured.getPointsAtLengths(lengths, vertices);
   }
-  else std::copy(source.begin() + fillStartIndex, source.begin() + fillEndIndex, back_inserter(filler));
+  else vertices = measured.getVertices();
   
+  output.setClosed(measured.isClosed());
   
-  output.addVertex(source.getPointAtIndexInterpolated(startIndex));
-  output.addVertices(filler);
-  output.addVertex(source.getPointAtIndexInterpolated(endIndex));
+  // Noise along the line at t, decorrelated between vertices by sampling row i
+  static thread_local std::vector<float> xs, ys, offsets;
+  const size_t len = vertices.size();
   
-  return output;
-}
-
-
-ofPolyline Line::getInterpolatedPolyline(const ofPolyline & source, const ofPolyline & target, float t){
-  if (source.size() != target.size())
+  xs.resize(len);
+  ys.resize(len);
+  offsets.resize(len);
+  
+  for (size_t i = 0; i < len; i++)
   {
-    ofLogWarning("Line::getInterpolatedPolyline") << "Source and Target polylines needs equal amount of vertices. Returning source line.."; return source;
+    xs[i] = (float) i / (len - 1);
+    ys[i] = (float) i;
   }
   
+  generators::Noise::getSignedNoise(xs.data(), ys.data(), len, offsets.data());
+  for (size_t i = 0; i < len; i++) offsets[i] *= amplitude;
+  
+  displaceAlongNormals(output, offsets.data());
+}
+  
+ofPolyline Line::getScribbledLine(const ofPolyline & source, float resolution, float amplitude)
+{
   ofPolyline output;
-  for (int i = 0; i < source.size(); i++) { output.addVertex(glm::mix(source[i], target[i], t)); }
+  scribbleLine(source, output, resolution, amplitude);
   return output;
 }
 
-void Line::scribbleLine(ofPolyline & source, float resolution, float amplitude)
+void Line::displaceAlongNormals(ofPolyline & source, const float * offsets)
 {
-  if (source.size() < 2) return;
+  std::vector<glm::vec3> & vertices = source.getVertices();
+  const size_t len = vertices.size();
+  if (len < 2) return;
+  
+  // All normals first, from the undisplaced vertices, in a single pass over the segments
+  static thread_local std::vector<glm::vec3> normals;
+  normals.resize(len);
   
-  source = source.getResampledBySpacing(resolution);
+  const bool closed = source.isClosed();
+  glm::vec3 incoming = (closed) ? vertices[0] - vertices[len - 1] : glm::vec3(0);
+  if (glm::length2(incoming) > 0.0f) incoming = glm::normalize(incoming);
   
-  for (int i = 0; i < source.size(); i++)
+  for (size_t i = 0; i < len; i++)
   {
-    glm::vec3 normal = source.getNormalAtIndex(i);
-    float t = (float) i / (source.size() - 1);
-    float offset = ofSignedNoise(t, i) * amplitude;
-    source[i] += normal * offset;
+    glm::vec3 outgoing(0);
+    if (closed || i + 1 < len) outgoing = vertices[(i + 1) % len] - vertices[i];
+    if (glm::length2(outgoing) > 0.0f) outgoing = glm::normalize(outgoing);
+    
+    const glm::vec3 normal = glm::cross(glm::vec3(0, 0, -1), incoming + outgoing);
+    const float length = glm::length(normal);
+    normals[i] = (length > 0.0f) ? normal / length : glm::vec3(0);
+    
+    incoming = outgoing;
   }
-}
   
-ofPolyline Line::getScribbledLine(const ofPolyline & source, float resolution, float amplitude)
+  for (size_t i = 0; i < len; i++) vertices[i] += normals[i] * offsets[i];
+  
+  source.flagHasChanged();
+}
+
+void Line::getScribbledLine(const ofPolyline * sources, size_t count, ofPolyline * output, float resolution, float amplitude)
 {
-  ofPolyline output = source;
-  scribbleLine(output, resolution, amplitude);
-  return output;
+  utils::Parallel::forEach(count, [&](size_t i) { scribbleLine(sources[i], output[i], resolution, amplitude); });
+}
+
+void Line::getScribbledLine(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float resolution, float amplitude)
+{
+  output.resize(sources.size());
+  getScribbledLine(sources.data(), sources.size(), output.data(), resolution, amplitude);
 }
 
 ofPolyline Line::getReversed(const ofPolyline &source)
@@ -397,19 +565,79 @@ ofPolyline Line::fromRectangle(const ofRectangle & rect)
   return line;
 }
 
-void Line::drawGradientLine(const ofPolyline & line, const ofColor & fromColor, const ofColor & toColor, float resolution)
+void Line::drawGradientLine(const ofPolyline & line, const ofColor & fromColor, const ofColor & toColor)
 {
-  ofPolyline subline = line.getResampledBySpacing(resolution);
+  // Colours are interpolated per vertex by arc length, so the line is drawn as it is
+  getGradientLineMesh(line, fromColor, toColor).draw();
+}
+
+ofMesh Line::getGradientLineMesh(const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor)
+{
+  ofMesh mesh;
+  mesh.setMode(OF_PRIMITIVE_LINE_STRIP);
+  
+  const auto & vertices = line.getVertices();
+  if (vertices.size() < 2) return mesh;
+  
+  const size_t numPoints = vertices.size() + line.isClosed();
+  const float total = MAX(getLength(line), std::numeric_limits<float>::epsilon());
+  
+  mesh.getVertices().reserve(numPoints);
+  mesh.getColors().reserve(numPoints);
+  
+  float length = 0.0f;
+  for (size_t i = 0; i < numPoints; i++)
+  {
+    if (i > 0) length += glm::distance(vertices[i - 1], vertices[i % vertices.size()]);
+    
+    mesh.addVertex(vertices[i % vertices.size()]);
+    mesh.addColor(fromColor.getLerped(toColor, length / total));
+  }
+  
+  return mesh;
+}
+
+void Line::appendGradientLine(ofMesh & output, const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor)
+{
+  output.setMode(OF_PRIMITIVE_LINES);
   
-  ofPushStyle();
-  for (int i = 0; i < subline.size() - 1; i++)
+  const auto & vertices = line.getVertices();
+  if (vertices.size() < 2) return;
+  
+  const size_t numSegments = vertices.size() - !line.isClosed();
+  const float total = MAX(getLength(line), std::numeric_limits<float>::epsilon());
+  
+  auto & outVertices = output.getVertices();
+  auto & outColors = output.getColors();
+  
+  float length = 0.0f;
+  ofFloatColor color = fromColor;
+  for (size_t i = 0; i < numSegments; i++)
   {
-    float t = (float) i / (subline.size() - 1);
+    const glm::vec3 & a = vertices[i];
+    const glm::vec3 & b = vertices[(i + 1) % vertices.size()];
+    
+    length += glm::distance(a, b);
+    const ofFloatColor next = fromColor.getLerped(toColor, length / total);
     
-    ofSetColor(fromColor.getLerped(toColor, t));
-    ofDrawLine(subline[i], subline[i+1]);
+    outVertices.push_back(a);
+    outVertices.push_back(b);
+    outColors.push_back(color);
+    outColors.push_back(next);
+    
+    color = next;
   }
-  ofPopStyle();
+}
+
+float Line::getLength(const ofPolyline & line)
+{
+  const auto & vertices = line.getVertices();
+  const size_t numPoints = vertices.size() + (line.isClosed() && vertices.size() > 1);
+  
+  float length = 0.0f;
+  for (size_t i = 1; i < numPoints; i++) length += glm::distance(vertices[i - 1], vertices[i % vertices.size()]);
+  
+  return length;
 }
 
 ofPolyline Line::getSimplifiedPolyline(const ofPolyline& source, float epsilon) 
@@ -419,84 +647,227 @@ ofPolyline Line::getSimplifiedPolyline(const ofPolyline& source, float epsilon)
     return source;
   }
   
-  std::vector<glm::vec3> points = source.getVertices();
-  std::vector<glm::vec3> simplifiedPoints;
-  simplifyRDP(points, 0, points.size() - 1, epsilon, simplifiedPoints, source.isClosed());
+  const std::vector<glm::vec3> & points = source.getVertices();
+  std::vector<bool> keep(points.size(), false);
+  
+  if (source.isClosed())
+  {
+    // Split the ring at the vertex farthest from the first one and simplify both halves
+    size_t farthest = 1;
+    float farthestDistance = -1.0f;
+    for (size_t i = 1; i < points.size(); i++)
+    {
+      float distance = glm::distance2(points[0], points[i]);
+      if (distance > farthestDistance) { farthestDistance = distance; farthest = i; }
+    }
+    
+    simplifyRDP(points, 0, farthest, epsilon, keep);
+    simplifyRDP(points, farthest, points.size(), epsilon, keep);
+  }
+  else simplifyRDP(points, 0, points.size() - 1, epsilon, keep);
   
-  ofPolyline simplifiedPolyline(simplifiedPoints);
+  ofPolyline simplifiedPolyline;
+  for (size_t i = 0; i < points.size(); i++) { if (keep[i]) simplifiedPolyline.addVertex(points[i]); }
   
   if (source.isClosed()) simplifiedPolyline.close();
   
   return simplifiedPolyline;
 }
 
+ofPolyline Line::getVisvalingamPolyline(const ofPolyline & source, float minArea, size_t minVertices)
+{
+  const std::vector<glm::vec3> & points = source.getVertices();
+  const size_t len = points.size();
+  const bool closed = source.isClosed();
+  
+  minVertices = std::max<size_t>(minVertices, (closed) ? 3 : 2);
+  if (len <= minVertices) return source;
+  
+  // Vertices stay in place and are unlinked as they go; the heap holds (area, index)
+  // pairs and entries whose area has changed since they were pushed are skipped.
+  std::vector<size_t> previous(len), next(len);
+  std::vector<float> areas(len, std::numeric_limits<float>::max());
+  std::vector<bool> removed(len, false);
+  
+  for (size_t i = 0; i < len; i++)
+  {
+    previous[i] = (i == 0) ? len - 1 : i - 1;
+    next[i] = (i + 1 == len) ? 0 : i + 1;
+  }
+  
+  auto getArea = [&](size_t i) -> float {
+    if (!closed && (i == 0 || i == len - 1)) return std::numeric_limits<float>::max();
+    return glm::length(glm::cross(points[previous[i]] - points[i], points[next[i]] - points[i])) * 0.5f;
+  };
+  
+  typedef std::pair<float, size_t> Entry;
+  std::vector<Entry> storage;
+  storage.reserve(len * 2);
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap(std::greater<Entry>(), std::move(storage));
+  
+  for (size_t i = 0; i < len; i++)
+  {
+    areas[i] = getArea(i);
+    if (areas[i] != std::numeric_limits<float>::max()) heap.push({ areas[i], i });
+  }
+  
+  size_t remaining = len;
+  float lastArea = 0.0f;
+  
+  while (!heap.empty() && remaining > minVertices)
+  {
+    const Entry entry = heap.top();
+    if (removed[entry.second] || entry.first != areas[entry.second]) { heap.pop(); continue; }
+    if (entry.first >= minArea) break;
+    heap.pop();
+    
+    const size_t i = entry.second;
+    removed[i] = true;
+    remaining--;
+    
+    next[previous[i]] = next[i];
+    previous[next[i]] = previous[i];
+    
+    // Neighbours never get a smaller effective area than the vertex just removed,
+    // otherwise the removal order (and thus the result) would depend on the threshold
+    lastArea = MAX(lastArea, entry.first);
+    for (size_t neighbour : { previous[i], next[i] })
+    {
+      float area = getArea(neighbour);
+      if (area == std::numeric_limits<float>::max()) continue;
+      
+      areas[neighbour] = MAX(area, lastArea);
+      heap.push({ areas[neighbour], neighbour });
+    }
+  }
+  
+  ofPolyline simplifiedPolyline;
+  for (size_t i = 0; i < len; i++) { if (!removed[i]) simplifiedPolyline.addVertex(points[i]); }
+  
+  if (closed) simplifiedPolyline.close();
+  
+  return simplifiedPolyline;
+}
+
 ofPolyline Line::getSubdividedPolyline(const ofPolyline & source, int iterations)
 {
+  ofPolyline output;
+  getSubdividedPolyline(source, output, iterations);
+  return output;
+}
+
+void Line::getSubdividedPolyline(const ofPolyline & source, ofPolyline & output, int iterations)
+{
+  if (source.size() == 0) { output.clear(); return; }
+  
   bool closed = source.isClosed();
   iterations = std::max(1, iterations);
   
-  std::vector<glm::vec3> currentPoints = source.getVertices();
-  std::vector<glm::vec3> subdividedPoints;
+  const glm::vec3 front = source.getVertices().front();
   
-  for (int i = 0; i < iterations; i++)
+  auto subdivide = [closed](const std::vector<glm::vec3> & points, std::vector<glm::vec3> & subdivided)
   {
-    for (int j = 0; j < currentPoints.size() - !closed; j++)
+    const size_t len = points.size();
+    subdivided.resize(len * 2 - !closed);
+    
+    glm::vec3 * out = subdivided.data();
+    for (size_t j = 0; j < len - !closed; j++)
     {
-      const glm::vec3 & current = currentPoints[(j + 0) % currentPoints.size()];
-      const glm::vec3 & next =    currentPoints[(j + 1) % currentPoints.size()];
+      const glm::vec3 & current = points[j];
+      const glm::vec3 & next = points[(j + 1 < len) ? j + 1 : 0];
       
-      subdividedPoints.push_back(current);
-      subdividedPoints.push_back(glm::mix(current, next, 0.5));
+      *out++ = current;
+      *out++ = glm::mix(current, next, 0.5);
     }
-    if (!closed) subdividedPoints.push_back(currentPoints.back());
-    
-    currentPoints = subdividedPoints;
-    subdividedPoints.clear();
-  }
+    if (!closed) *out++ = points[len - 1];
+  };
   
-  if (closed) currentPoints.push_back(source.getVertices().front());
+  pingPong(source, output, iterations, getSubdividedSize(source.size(), closed, iterations), subdivide);
   
-  return ofPolyline(currentPoints);
+  if (closed) output.getVertices().push_back(front);
+  output.setClosed(false);
 }
 
-void Line::simplifyRDP(const std::vector<glm::vec3>& points, int startIdx, int endIdx, float epsilon, std::vector<glm::vec3>& simplifiedPoints, bool isClosed)
+size_t Line::getSubdividedSize(size_t numVertices, bool closed, int iterations)
 {
-  epsilon = std::max(epsilon, 0.0f);
+  if (numVertices == 0) return 0;
   
-  float dmax = 0;
-  int index = 0;
-  int n = points.size();
+  iterations = std::max(1, iterations);
+  return (closed) ? (numVertices << iterations) + 1 : ((numVertices - 1) << iterations) + 1;
+}
 
-  for (int i = startIdx + 1; i < endIdx; ++i) {
-      float d = lineDistance(points[i], points[startIdx], points[endIdx]);
-      if (d > dmax) {
-          dmax = d;
-          index = i;
-      }
-  }
+void Line::getChaikin(const ofPolyline * sources, size_t count, ofPolyline * output, int iterations, float tension)
+{
+  utils::Parallel::forEach(count, [&](size_t i) { chaikin(sources[i], output[i], iterations, tension); });
+}
 
-  if (isClosed && startIdx == 0 && endIdx == points.size() - 1) {
-      // If the polyline is closed and the start and end points are being considered, add them to the simplified polyline.
-      simplifiedPoints.push_back(points[startIdx]);
-      if (dmax > epsilon) {
-          simplifyRDP(points, startIdx, index, epsilon, simplifiedPoints, isClosed);
-          simplifyRDP(points, index, endIdx, epsilon, simplifiedPoints, isClosed);
-      }
-      return;
-  }
+void Line::getChaikin(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, int iterations, float tension)
+{
+  output.resize(sources.size());
+  getChaikin(sources.data(), sources.size(), output.data(), iterations, tension);
+}
 
-  if (dmax > epsilon) {
-      // If the maximum distance is greater than epsilon, recursively simplify both subparts
-      simplifyRDP(points, startIdx, index, epsilon, simplifiedPoints, isClosed);
-      simplifyRDP(points, index, endIdx, epsilon, simplifiedPoints, isClosed);
-  } else {
-      // If not, add the start point to the simplified polyline
-      simplifiedPoints.push_back(points[startIdx]);
-
-      if (!isClosed || endIdx != points.size() - 2) {
-          // If the polyline is open or the end point is not the last point, add the end point to the simplified polyline.
-          simplifiedPoints.push_back(points[endIdx]);
-      }
+void Line::getSimplifiedPolyline(const ofPolyline * sources, size_t count, ofPolyline * output, float epsilon)
+{
+  utils::Parallel::forEach(count, [&](size_t i) { output[i] = getSimplifiedPolyline(sources[i], epsilon); });
+}
+
+void Line::getSimplifiedPolyline(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float epsilon)
+{
+  output.resize(sources.size());
+  getSimplifiedPolyline(sources.data(), sources.size(), output.data(), epsilon);
+}
+
+void Line::getOffset(const ofPolyline * sources, size_t count, ofPolyline * output, float offset, ClipperLib::JoinType jointype, ClipperLib::EndType endtype)
+{
+  utils::Parallel::forEach(count, [&](size_t i) { output[i] = getOffset(sources[i], offset, jointype, endtype); });
+}
+
+void Line::getOffset(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float offset, ClipperLib::JoinType jointype, ClipperLib::EndType endtype)
+{
+  output.resize(sources.size());
+  getOffset(sources.data(), sources.size(), output.data(), offset, jointype, endtype);
+}
+
+void Line::simplifyRDP(const std::vector<glm::vec3>& points, size_t startIdx, size_t endIdx, float epsilon, std::vector<bool>& keep)
+{
+  // `endIdx` may equal points.size() to stand for the first vertex of a closed ring
+  const size_t len = points.size();
+  const float epsilon2 = std::max(epsilon, 0.0f) * std::max(epsilon, 0.0f);
+  
+  keep[startIdx % len] = true;
+  keep[endIdx % len] = true;
+  
+  // Explicit stack instead of recursion, long traces would otherwise overflow the call stack
+  std::vector<std::pair<size_t, size_t>> stack;
+  stack.emplace_back(startIdx, endIdx);
+  
+  while (!stack.empty())
+  {
+    const size_t start = stack.back().first;
+    const size_t end = stack.back().second;
+    stack.pop_back();
+    
+    if (end <= start + 1) continue;
+    
+    const glm::vec3 & a = points[start % len];
+    const glm::vec3 & b = points[end % len];
+    
+    float dmax = 0.0f;
+    size_t index = start;
+    
+    for (size_t i = start + 1; i < end; i++)
+    {
+      float d = squaredLineDistance(points[i], a, b);
+      if (d > dmax) { dmax = d; index = i; }
+    }
+    
+    if (dmax > epsilon2)
+    {
+      keep[index] = true;
+      stack.emplace_back(start, index);
+      stack.emplace_back(index, end);
+    }
   }
 }
 
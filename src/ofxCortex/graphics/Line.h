@@ -9,6 +9,7 @@
 #include "ofxCortex/utils/VectorUtils.h"
 #include "ofxCortex/utils/NumberUtils.h"
 #include "ofxCortex/utils/DebugUtils.h"
+#include "ofxCortex/utils/ParallelUtils.h"
 
 namespace ofxCortex { namespace core { namespace graphics {
 
@@ -26,12 +27,25 @@ public:
   static void catmullRom(ofPolyline & source, int iterations = 10);
   static ofPolyline getCatmullRom(const ofPolyline & source, int iterations = 10);
   
-  static void chaikin(ofPolyline & source, int iterations = 4, float tension = 0.5f);
+  // Picks the number of steps per segment from its curvature, so the output stays within `tolerance`
+  // of the spline: straight runs get a single step and tight turns as many as they need (up to maxSteps).
+  // alpha = 0 is the uniform spline, 0.5 centripetal (no cusps or loops), 1 chordal.
+  // Closed sources produce closed splines. `output` keeps its allocation between calls.
+  static void adaptiveCatmullRom(ofPolyline & source, float tolerance = 0.25f, float alpha = 0.5f, int maxSteps = 256) { adaptiveCatmullRom(source, source, tolerance, alpha, maxSteps); };
+  static void adaptiveCatmullRom(const ofPolyline & source, ofPolyline & output, float tolerance = 0.25f, float alpha = 0.5f, int maxSteps = 256);
+  static ofPolyline getAdaptiveCatmullRom(const ofPolyline & source, float tolerance = 0.25f, float alpha = 0.5f, int maxSteps = 256);
+  
+  static void chaikin(ofPolyline & source, int iterations = 4, float tension = 0.5f) { chaikin(source, source, iterations, tension); };
+  static void chaikin(const ofPolyline & source, ofPolyline & output, int iterations = 4, float tension = 0.5f);
   static ofPolyline getChaikin(const ofPolyline & source, int iterations = 4, float tension = 0.5f);
   
-  static void scribbleLine(ofPolyline & source, float resolution, float amplitude);
+  static void scribbleLine(ofPolyline & source, float resolution, float amplitude) { scribbleLine(source, source, resolution, amplitude); };
+  static void scribbleLine(const ofPolyline & source, ofPolyline & output, float resolution, float amplitude);
   static ofPolyline getScribbledLine(const ofPolyline & source, float resolution, float amplitude);
   
+  // Moves every vertex along its normal (same convention as ofPolyline::getNormalAtIndex) by offsets[i]
+  static void displaceAlongNormals(ofPolyline & source, const float * offsets);
+  
   static ofPolyline getRoundedPolyline(const ofPolyline & source, const std::vector<float> & radiuses);
   static ofPolyline getRoundedPolyline(const ofPolyline & source, float radius) { return getRoundedPolyline(source, std::vector<float>{ radius });};
   
@@ -54,24 +68,67 @@ public:
   
   static ofPolyline fromRectangle(const ofRectangle & rect);
   
-  static void drawGradientLine(const ofPolyline & line, const ofColor & fromColor, const ofColor & toColor, float resolution = 2.0);
+  static void drawGradientLine(const ofPolyline & line, const ofColor & fromColor, const ofColor & toColor);
+  [[deprecated("the line is no longer resampled, use drawGradientLine(line, fromColor, toColor)")]]
+  static void drawGradientLine(const ofPolyline & line, const ofColor & fromColor, const ofColor & toColor, float /*resolution*/) { drawGradientLine(line, fromColor, toColor); }
+  
+  // Line strip with colours interpolated along the arc length, drawn in a single call
+  static ofMesh getGradientLineMesh(const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor);
+  // Appends the same line as segment pairs to an OF_PRIMITIVE_LINES mesh, so many lines can share one draw
+  static void appendGradientLine(ofMesh & output, const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor);
   
   static void simplifyPolyline(ofPolyline & source, float epsilon = 0.5) { source = getSimplifiedPolyline(source, epsilon); };
   static ofPolyline getSimplifiedPolyline(const ofPolyline& source, float epsilon = 0.5);
   
-  static void subdividePolyline(ofPolyline & source, int iterations = 1) { source = getSubdividedPolyline(source, iterations); };
+  // Visvalingam-Whyatt: repeatedly drops the vertex spanning the smallest triangle with its
+  // neighbours, until every remaining one spans at least `minArea` or `minVertices` are left.
+  // Use minArea = std::numeric_limits<float>::max() to simplify down to a vertex count.
+  static void simplifyVisvalingam(ofPolyline & source, float minArea, size_t minVertices = 0) { source = getVisvalingamPolyline(source, minArea, minVertices); };
+  static ofPolyline getVisvalingamPolyline(const ofPolyline & source, float minArea, size_t minVertices = 0);
+  
+  static void subdividePolyline(ofPolyline & source, int iterations = 1) { getSubdividedPolyline(source, source, iterations); };
   static ofPolyline getSubdividedPolyline(const ofPolyline & source, int iterations = 1);
+  static void getSubdividedPolyline(const ofPolyline & source, ofPolyline & output, int iterations = 1);
+  
+  // Vertex counts after chaikin() / getSubdividedPolyline(), without running them
+  static size_t getChaikinSize(size_t numVertices, int iterations) { return (numVertices < 3) ? numVertices : numVertices << std::max(1, iterations); };
+  static size_t getSubdividedSize(size_t numVertices, bool closed, int iterations);
+  
+  // Batch processing: spread over utils::Parallel's shared pool. output[i] always
+  // holds the result for sources[i]; an output of the right size is reused as is.
+  static void getChaikin(const ofPolyline * sources, size_t count, ofPolyline * output, int iterations = 4, float tension = 0.5f);
+  static void getChaikin(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, int iterations = 4, float tension = 0.5f);
+  
+  static void getSimplifiedPolyline(const ofPolyline * sources, size_t count, ofPolyline * output, float epsilon = 0.5);
+  static void getSimplifiedPolyline(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float epsilon = 0.5);
+  
+  static void getScribbledLine(const ofPolyline * sources, size_t count, ofPolyline * output, float resolution, float amplitude);
+  static void getScribbledLine(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float resolution, float amplitude);
+  
+  static void getOffset(const ofPolyline * sources, size_t count, ofPolyline * output, float offset, ClipperLib::JoinType jointype = ClipperLib::jtSquare, ClipperLib::EndType endtype = ClipperLib::etOpenSquare);
+  static void getOffset(const std::vector<ofPolyline> & sources, std::vector<ofPolyline> & output, float offset, ClipperLib::JoinType jointype = ClipperLib::jtSquare, ClipperLib::EndType endtype = ClipperLib::etOpenSquare);
   
 private:
   Line() = default;
   
-  static void simplifyRDP(const std::vector<glm::vec3>& points, int startIdx, int endIdx, float epsilon, std::vector<glm::vec3>& simplifiedPoints, bool isClosed);
+  // Summed segment lengths, without touching the polyline's own (non thread-safe) length cache
+  static float getLength(const ofPolyline & line);
+  
+  // p0..p3 around `segment`, with phantom end points on open lines
+  static void getCatmullRomControls(const std::vector<glm::vec3> & points, bool closed, size_t segment, glm::vec3 * controls);
+  
+  template<typename Pass>
+  static void pingPong(const ofPolyline & source, ofPolyline & output, int iterations, size_t finalSize, Pass && pass);
+  
+  static void simplifyRDP(const std::vector<glm::vec3>& points, size_t startIdx, size_t endIdx, float epsilon, std::vector<bool>& keep);
 
-  static float lineDistance(const glm::vec3 & point, const glm::vec3 & start, const glm::vec3 & end) {
-    // Calculate the perpendicular distance from a point to a line
-    float num = abs((end.y - start.y) * point.x - (end.x - start.x) * point.y + end.x * start.y - end.y * start.x);
-    float den = sqrt(pow(end.y - start.y, 2) + pow(end.x - start.x, 2));
-    return num / den;
+  // Squared distance from a point to the infinite line through start and end
+  static float squaredLineDistance(const glm::vec3 & point, const glm::vec3 & start, const glm::vec3 & end) {
+    const glm::vec3 direction = end - start;
+    const float length2 = glm::length2(direction);
+    
+    if (length2 == 0.0f) return glm::length2(point - start);
+    return glm::length2(glm::cross(point - start, direction)) / length2;
   }
 };
 
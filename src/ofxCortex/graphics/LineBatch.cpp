@@ -0,0 +1,75 @@
+#include "LineBatch.h"
+
+#include "Line.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+void LineBatch::begin()
+{
+  lineMesh.clear();
+  triangleMesh.clear();
+  
+  lineMesh.setMode(OF_PRIMITIVE_LINES);
+  triangleMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+}
+
+template<typename ColorAt>
+void LineBatch::appendSegments(const ofPolyline & line, ColorAt colorAt)
+{
+  const auto & vertices = line.getVertices();
+  if (vertices.size() < 2) return;
+  
+  const size_t numSegments = vertices.size() - !line.isClosed();
+  auto & outVertices = lineMesh.getVertices();
+  auto & outColors = lineMesh.getColors();
+  
+  for (size_t i = 0; i < numSegments; i++)
+  {
+    const size_t next = (i + 1) % vertices.size();
+    
+    outVertices.push_back(vertices[i]);
+    outVertices.push_back(vertices[next]);
+    outColors.push_back(colorAt(i));
+    outColors.push_back(colorAt(next));
+  }
+}
+
+void LineBatch::addLine(const ofPolyline & line, const ofFloatColor & color)
+{
+  appendSegments(line, [&color](size_t) -> const ofFloatColor & { return color; });
+}
+
+void LineBatch::addLine(const ofPolyline & line, const std::vector<ofFloatColor> & colors)
+{
+  if (colors.empty()) { addLine(line, ofFloatColor::white); return; }
+  
+  appendSegments(line, [&colors](size_t i) -> const ofFloatColor & { return colors[MIN(i, colors.size() - 1)]; });
+}
+
+void LineBatch::addGradientLine(const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor)
+{
+  Line::appendGradientLine(lineMesh, line, fromColor, toColor);
+}
+
+void LineBatch::addThickLine(const ofPolyline & line, const LineMesh::Settings & settings, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors)
+{
+  LineMesh::build(line, triangleMesh, settings, widths, colors);
+}
+
+void LineBatch::draw()
+{
+  // Streamed every frame, the driver can orphan the previous buffer instead of stalling on it
+  if (lineMesh.getNumVertices() > 0)
+  {
+    lineVbo.setMesh(lineMesh, GL_STREAM_DRAW);
+    lineVbo.draw(GL_LINES, 0, lineMesh.getNumVertices());
+  }
+  
+  if (triangleMesh.getNumIndices() > 0)
+  {
+    triangleVbo.setMesh(triangleMesh, GL_STREAM_DRAW);
+    triangleVbo.drawElements(GL_TRIANGLES, triangleMesh.getNumIndices());
+  }
+}
+
+}}}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofVbo.h"
+#include "ofPolyline.h"
+
+#include "LineMesh.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Accumulates every line drawn in a frame into two meshes, hairlines as
+// GL_LINES and thick lines as indexed triangles, then uploads and draws each of
+// them with a single call. The buffers keep their capacity between frames.
+//
+//   batch.begin();
+//   for (auto & line : lines) batch.addGradientLine(line, from, to);
+//   batch.draw();
+class LineBatch {
+public:
+  // Clears the accumulated geometry, keeping the allocations
+  void begin();
+  
+  void addLine(const ofPolyline & line, const ofFloatColor & color);
+  // One colour per vertex, the last one is repeated when `colors` is shorter than the line
+  void addLine(const ofPolyline & line, const std::vector<ofFloatColor> & colors);
+  void addGradientLine(const ofPolyline & line, const ofFloatColor & fromColor, const ofFloatColor & toColor);
+  void addThickLine(const ofPolyline & line, const LineMesh::Settings & settings, const std::vector<float> & widths = {}, const std::vector<ofFloatColor> & colors = {});
+  
+  // Uploads the accumulated geometry, then issues one draw call per non-empty mesh
+  void draw();
+  
+  const ofMesh & getLineMesh() const { return lineMesh; }
+  const ofMesh & getTriangleMesh() const { return triangleMesh; }
+  bool empty() const { return lineMesh.getNumVertices() == 0 && triangleMesh.getNumVertices() == 0; }
+
+protected:
+  ofMesh lineMesh;
+  ofMesh triangleMesh;
+  
+  ofVbo lineVbo;
+  ofVbo triangleVbo;
+  
+  template<typename ColorAt>
+  void appendSegments(const ofPolyline & line, ColorAt colorAt);
+};
+
+}}}
@@ -0,0 +1,203 @@
+#include "LineMesh.h"
+
+#include "ofxCortex/utils/HashUtils.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+bool LineMesh::update(const ofPolyline & line, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors)
+{
+  const uint64_t newHash = getHash(line, settings, widths, colors);
+  if (newHash == hash && hash != 0) return false;
+  
+  hash = newHash;
+  mesh.clear();
+  build(line, mesh, settings, widths, colors);
+  
+  return true;
+}
+
+ofMesh LineMesh::getMesh(const ofPolyline & line, const Settings & settings, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors)
+{
+  ofMesh mesh;
+  build(line, mesh, settings, widths, colors);
+  return mesh;
+}
+
+void LineMesh::build(const ofPolyline & line, ofMesh & output, const Settings & settings, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors)
+{
+  output.setMode(OF_PRIMITIVE_TRIANGLES);
+  
+  // Consecutive duplicates have no direction, drop them (keeping the attributes of the first)
+  struct Point { glm::vec3 position; float halfWidth; ofFloatColor color; };
+  std::vector<Point> points;
+  points.reserve(line.size());
+  
+  const auto & vertices = line.getVertices();
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    if (!points.empty() && glm::length2(vertices[i] - points.back().position) == 0.0f) continue;
+    
+    const float width = (widths.empty()) ? settings.width : widths[MIN(i, widths.size() - 1)];
+    const ofFloatColor & color = (colors.empty()) ? settings.color : colors[MIN(i, colors.size() - 1)];
+    points.push_back({ vertices[i], MAX(width, 0.0f) * 0.5f, color });
+  }
+  
+  const bool closed = line.isClosed() && points.size() > 2;
+  if (closed && glm::length2(points.front().position - points.back().position) == 0.0f) points.pop_back();
+  if (points.size() < 2) return;
+  
+  const size_t len = points.size();
+  const size_t numSegments = (closed) ? len : len - 1;
+  const float angleStep = PI / MAX(settings.roundResolution, 1);
+  
+  auto & outVertices = output.getVertices();
+  auto & outColors = output.getColors();
+  auto & outIndices = output.getIndices();
+  
+  // Grow geometrically, many lines are usually appended to the same mesh
+  auto reserve = [](auto & buffer, size_t extra) {
+    if (buffer.size() + extra > buffer.capacity()) buffer.reserve(MAX(buffer.size() + extra, buffer.capacity() * 2));
+  };
+  reserve(outVertices, numSegments * 4 + len * 4);
+  reserve(outColors, numSegments * 4 + len * 4);
+  reserve(outIndices, numSegments * 6 + len * 9);
+  
+  auto addVertex = [&](const glm::vec3 & position, const ofFloatColor & color) -> ofIndexType {
+    outVertices.push_back(position);
+    outColors.push_back(color);
+    return outVertices.size() - 1;
+  };
+  
+  auto addTriangle = [&](ofIndexType a, ofIndexType b, ofIndexType c) {
+    outIndices.push_back(a);
+    outIndices.push_back(b);
+    outIndices.push_back(c);
+  };
+  
+  auto getDirection = [&](size_t segment) -> glm::vec2 {
+    return glm::normalize(glm::vec2(points[(segment + 1) % len].position - points[segment].position));
+  };
+  
+  auto getNormal = [](const glm::vec2 & direction) { return glm::vec3(-direction.y, direction.x, 0.0f); };
+  
+  // Fan around `center`, starting at offset `from` and rotating it by `angle` radians
+  auto addFan = [&](const Point & center, const glm::vec3 & from, float angle) {
+    const int steps = MAX((int) ceil(fabs(angle) / angleStep), 1);
+    const ofIndexType centerIndex = addVertex(center.position, center.color);
+    
+    ofIndexType previous = addVertex(center.position + from, center.color);
+    for (int step = 1; step <= steps; step++)
+    {
+      const float a = angle * step / steps;
+      const glm::vec3 offset(from.x * cos(a) - from.y * sin(a), from.x * sin(a) + from.y * cos(a), 0.0f);
+      const ofIndexType current = addVertex(center.position + offset, center.color);
+      addTriangle(centerIndex, previous, current);
+      previous = current;
+    }
+  };
+  
+  // Segment bodies
+  for (size_t segment = 0; segment < numSegments; segment++)
+  {
+    const Point & a = points[segment];
+    const Point & b = points[(segment + 1) % len];
+    const glm::vec2 direction = getDirection(segment);
+    const glm::vec3 normal = getNormal(direction);
+    
+    glm::vec3 start = a.position;
+    glm::vec3 end = b.position;
+    
+    if (!closed && settings.cap == CAP_SQUARE)
+    {
+      if (segment == 0) start -= glm::vec3(direction, 0.0f) * a.halfWidth;
+      if (segment == numSegments - 1) end += glm::vec3(direction, 0.0f) * b.halfWidth;
+    }
+    
+    const ofIndexType i0 = addVertex(start + normal * a.halfWidth, a.color);
+    const ofIndexType i1 = addVertex(start - normal * a.halfWidth, a.color);
+    const ofIndexType i2 = addVertex(end + normal * b.halfWidth, b.color);
+    const ofIndexType i3 = addVertex(end - normal * b.halfWidth, b.color);
+    
+    addTriangle(i0, i1, i2);
+    addTriangle(i2, i1, i3);
+  }
+  
+  // Joins, on the outer side of every turn
+  for (size_t i = (closed) ? 0 : 1; i < ((closed) ? len : len - 1); i++)
+  {
+    const Point & point = points[i];
+    if (point.halfWidth <= 0.0f) continue;
+    
+    const glm::vec2 incoming = getDirection((i + numSegments - 1) % numSegments);
+    const glm::vec2 outgoing = getDirection(i);
+    const float turn = incoming.x * outgoing.y - incoming.y * outgoing.x;
+    if (fabs(turn) < 1e-6f && glm::dot(incoming, outgoing) > 0.0f) continue;
+    
+    const float side = (turn > 0.0f) ? -1.0f : 1.0f;
+    const glm::vec3 from = getNormal(incoming) * point.halfWidth * side;
+    const glm::vec3 to = getNormal(outgoing) * point.halfWidth * side;
+    
+    JoinType join = settings.join;
+    glm::vec3 miter;
+    
+    if (join == JOIN_MITER)
+    {
+      const glm::vec3 bisector = getNormal(incoming) + getNormal(outgoing);
+      const float bisectorLength = glm::length(bisector);
+      const float cosHalfAngle = bisectorLength * 0.5f;
+      
+      if (bisectorLength < 1e-6f || 1.0f / cosHalfAngle > settings.miterLimit) join = JOIN_BEVEL;
+      else miter = bisector / bisectorLength * (point.halfWidth / cosHalfAngle) * side;
+    }
+    
+    if (join == JOIN_ROUND)
+    {
+      // The outer offset turns by the same angle as the line itself
+      addFan(point, from, atan2(turn, glm::dot(incoming, outgoing)));
+      continue;
+    }
+    
+    const ofIndexType center = addVertex(point.position, point.color);
+    const ofIndexType a = addVertex(point.position + from, point.color);
+    const ofIndexType b = addVertex(point.position + to, point.color);
+    
+    if (join == JOIN_MITER)
+    {
+      const ofIndexType tip = addVertex(point.position + miter, point.color);
+      addTriangle(center, a, tip);
+      addTriangle(center, tip, b);
+    }
+    else addTriangle(center, a, b);
+  }
+  
+  // Round caps on open lines, half a turn around each end
+  if (!closed && settings.cap == CAP_ROUND)
+  {
+    const glm::vec3 startNormal = getNormal(getDirection(0));
+    const glm::vec3 endNormal = getNormal(getDirection(numSegments - 1));
+    
+    if (points.front().halfWidth > 0.0f) addFan(points.front(), startNormal * points.front().halfWidth, PI);
+    if (points.back().halfWidth > 0.0f) addFan(points.back(), -endNormal * points.back().halfWidth, PI);
+  }
+}
+
+uint64_t LineMesh::getHash(const ofPolyline & line, const Settings & settings, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors)
+{
+  const float numbers[3] = { settings.width, settings.miterLimit, (float) settings.roundResolution };
+  const int types[2] = { settings.join, settings.cap };
+  
+  uint64_t hash = utils::hashBytes(numbers, sizeof(numbers));
+  hash = utils::hashBytes(types, sizeof(types), hash);
+  hash = utils::hashBytes(&settings.color, sizeof(settings.color), hash);
+  hash = utils::hashVertices(line, hash);
+  
+  // Sizes first, like the vertex count, so bytes cannot move between the attribute vectors unnoticed
+  const uint64_t sizes[2] = { widths.size(), colors.size() };
+  hash = utils::hashBytes(sizes, sizeof(sizes), hash);
+  if (!widths.empty()) hash = utils::hashBytes(widths.data(), widths.size() * sizeof(float), hash);
+  if (!colors.empty()) hash = utils::hashBytes(colors.data(), colors.size() * sizeof(ofFloatColor), hash);
+  
+  return (hash == 0) ? 1 : hash;
+}
+
+}}}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Tessellates thick lines straight into triangles on the CPU, without going
+// through Clipper and ofPath. Widths and colours can vary per vertex. Segments
+// are quads and joins fill the outer wedge only, so with translucent colours
+// the inside of sharp turns is covered twice.
+//
+// Use the static build() for one-off meshes, or keep a LineMesh around and call
+// update() every frame: the mesh is only rebuilt when the input changed.
+class LineMesh {
+public:
+  enum JoinType { JOIN_MITER, JOIN_ROUND, JOIN_BEVEL };
+  enum CapType { CAP_BUTT, CAP_SQUARE, CAP_ROUND };
+  
+  struct Settings {
+    float width { 1.0f };
+    JoinType join { JOIN_MITER };
+    CapType cap { CAP_BUTT };
+    float miterLimit { 4.0f }; // miter length relative to the half width before falling back to a bevel
+    int roundResolution { 16 }; // segments per half turn for round joins and caps
+    ofFloatColor color { ofFloatColor::white };
+  };
+  
+  LineMesh() {};
+  LineMesh(const Settings & settings) : settings(settings) {};
+  
+  // `widths` and `colors` are per vertex; when shorter than the line their last value is repeated.
+  // Returns true when the mesh had to be rebuilt.
+  bool update(const ofPolyline & line, const std::vector<float> & widths = {}, const std::vector<ofFloatColor> & colors = {});
+  
+  void setSettings(const Settings & settings) { this->settings = settings; hash = 0; }
+  const Settings & getSettings() const { return settings; }
+  
+  const ofMesh & getMesh() const { return mesh; }
+  void draw() const { mesh.draw(); }
+  
+  // Appends the triangles for `line` to `output` (OF_PRIMITIVE_TRIANGLES, indexed, coloured).
+  static void build(const ofPolyline & line, ofMesh & output, const Settings & settings, const std::vector<float> & widths = {}, const std::vector<ofFloatColor> & colors = {});
+  static ofMesh getMesh(const ofPolyline & line, const Settings & settings, const std::vector<float> & widths = {}, const std::vector<ofFloatColor> & colors = {});
+
+protected:
+  Settings settings;
+  ofMesh mesh;
+  uint64_t hash { 0 };
+  
+  static uint64_t getHash(const ofPolyline & line, const Settings & settings, const std::vector<float> & widths, const std::vector<ofFloatColor> & colors);
+};
+
+}}}
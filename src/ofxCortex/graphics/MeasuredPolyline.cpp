@@ -0,0 +1,209 @@
+#include "MeasuredPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+void MeasuredPolyline::setup(const ofPolyline & source)
+{
+  vertices = source.getVertices();
+  closed = source.isClosed() && vertices.size() > 2;
+  
+  const size_t numSegments = (vertices.size() < 2) ? 0 : (closed) ? vertices.size() : vertices.size() - 1;
+  
+  lengths.assign(numSegments + 1, 0.0f);
+  directions.assign(numSegments, glm::vec3(0));
+  normals.assign(vertices.size(), glm::vec3(0));
+  
+  if (vertices.empty()) { lengths.clear(); return; }
+  
+  for (size_t i = 0; i < numSegments; i++)
+  {
+    const glm::vec3 delta = vertices[getEndVertex(i)] - vertices[i];
+    const float length = glm::length(delta);
+    
+    lengths[i + 1] = lengths[i] + length;
+    directions[i] = (length > 0.0f) ? delta / length : glm::vec3(0);
+  }
+  
+  // Same convention as ofPolyline: the normal is the tangent rotated by cross((0, 0, -1), tangent)
+  for (size_t i = 0; i < vertices.size() && numSegments > 0; i++)
+  {
+    glm::vec3 tangent(0);
+    if (closed || i > 0) tangent += directions[(i == 0) ? numSegments - 1 : i - 1];
+    if (closed || i < numSegments) tangent += directions[MIN(i, numSegments - 1)];
+    
+    const glm::vec3 normal = glm::cross(glm::vec3(0, 0, -1), tangent);
+    const float length = glm::length(normal);
+    normals[i] = (length > 0.0f) ? normal / length : glm::vec3(0);
+  }
+}
+
+float MeasuredPolyline::getIndexAtLength(float length) const
+{
+  if (lengths.size() < 2) return 0.0f;
+  
+  const Location location = locate(length);
+  return location.segment + location.t;
+}
+
+glm::vec3 MeasuredPolyline::getPointAtLength(float length) const
+{
+  if (vertices.empty()) return glm::vec3(0);
+  if (lengths.size() < 2) return vertices[0];
+  
+  return getPoint(locate(length));
+}
+
+glm::vec3 MeasuredPolyline::getTangentAtLength(float length) const
+{
+  if (directions.empty()) return glm::vec3(0);
+  
+  return directions[locate(length).segment];
+}
+
+glm::vec3 MeasuredPolyline::getNormalAtLength(float length) const
+{
+  if (directions.empty()) return glm::vec3(0);
+  
+  return getNormal(locate(length));
+}
+
+ofPolyline MeasuredPolyline::getSubsection(float start, float end) const
+{
+  ofPolyline output;
+  if (lengths.size() < 2) return output;
+  
+  const float total = getLength();
+  
+  if (!closed)
+  {
+    if (start > end) std::swap(start, end);
+    start = ofClamp(start, 0.0f, total);
+    end = ofClamp(end, 0.0f, total);
+  }
+  else
+  {
+    start = wrap(start);
+    end = wrap(end);
+    if (end <= start) end += total;
+  }
+  
+  // On a wrapping closed line the end can sit one lap ahead of the start
+  const bool nextLap = closed && end >= total;
+  const Location first = locate(start);
+  const Location last = locate((nextLap) ? end - total : end);
+  const size_t lastSegment = last.segment + ((nextLap) ? directions.size() : 0);
+  
+  auto add = [&output](const glm::vec3 & point) {
+    if (output.size() == 0 || output[output.size() - 1] != point) output.addVertex(point);
+  };
+  
+  add(getPoint(first));
+  for (size_t segment = first.segment; segment < lastSegment; segment++) add(vertices[getEndVertex(segment % directions.size())]);
+  add(getPoint(last));
+  
+  return output;
+}
+
+void MeasuredPolyline::getPointsAtLengths(const float * queries, size_t count, glm::vec3 * output) const
+{
+  if (lengths.size() < 2)
+  {
+    std::fill(output, output + count, (vertices.empty()) ? glm::vec3(0) : vertices[0]);
+    return;
+  }
+  
+  size_t hint = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    const Location location = locate(queries[i], hint);
+    output[i] = getPoint(location);
+    hint = location.segment;
+  }
+}
+
+void MeasuredPolyline::getPointsAtLengths(const std::vector<float> & queries, std::vector<glm::vec3> & output) const
+{
+  output.resize(queries.size());
+  getPointsAtLengths(queries.data(), queries.size(), output.data());
+}
+
+void MeasuredPolyline::getFramesAtLengths(const float * queries, size_t count, glm::vec3 * outPoints, glm::vec3 * outTangents, glm::vec3 * outNormals) const
+{
+  if (lengths.size() < 2)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      if (outPoints) outPoints[i] = (vertices.empty()) ? glm::vec3(0) : vertices[0];
+      if (outTangents) outTangents[i] = glm::vec3(0);
+      if (outNormals) outNormals[i] = glm::vec3(0);
+    }
+    return;
+  }
+  
+  size_t hint = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    const Location location = locate(queries[i], hint);
+    if (outPoints) outPoints[i] = getPoint(location);
+    if (outTangents) outTangents[i] = directions[location.segment];
+    if (outNormals) outNormals[i] = getNormal(location);
+    hint = location.segment;
+  }
+}
+
+float MeasuredPolyline::wrap(float length) const
+{
+  const float total = getLength();
+  if (total <= 0.0f) return 0.0f;
+  
+  length = fmod(length, total);
+  return (length < 0.0f) ? length + total : length;
+}
+
+MeasuredPolyline::Location MeasuredPolyline::locate(float length) const
+{
+  length = (closed) ? wrap(length) : ofClamp(length, 0.0f, getLength());
+  
+  // First vertex past `length`, the segment before it holds the point
+  size_t segment = std::upper_bound(lengths.begin(), lengths.end(), length) - lengths.begin();
+  segment = CLAMP(segment, (size_t) 1, directions.size()) - 1;
+  
+  const float segmentLength = lengths[segment + 1] - lengths[segment];
+  const float t = (segmentLength > 0.0f) ? ofClamp((length - lengths[segment]) / segmentLength, 0.0f, 1.0f) : 0.0f;
+  
+  return { segment, t };
+}
+
+MeasuredPolyline::Location MeasuredPolyline::locate(float length, size_t hint) const
+{
+  length = (closed) ? wrap(length) : ofClamp(length, 0.0f, getLength());
+  
+  // Sorted queries advance a few segments at a time; anything else falls back to a binary search
+  size_t segment = MIN(hint, directions.size() - 1);
+  if (length < lengths[segment]) return locate(length);
+  
+  for (int steps = 0; length > lengths[segment + 1] && segment + 1 < directions.size(); steps++, segment++)
+  {
+    if (steps == 8) return locate(length);
+  }
+  
+  const float segmentLength = lengths[segment + 1] - lengths[segment];
+  const float t = (segmentLength > 0.0f) ? ofClamp((length - lengths[segment]) / segmentLength, 0.0f, 1.0f) : 0.0f;
+  
+  return { segment, t };
+}
+
+glm::vec3 MeasuredPolyline::getPoint(const Location & location) const
+{
+  return glm::mix(vertices[location.segment], vertices[getEndVertex(location.segment)], location.t);
+}
+
+glm::vec3 MeasuredPolyline::getNormal(const Location & location) const
+{
+  const glm::vec3 normal = glm::mix(normals[location.segment], normals[getEndVertex(location.segment)], location.t);
+  const float length = glm::length(normal);
+  
+  return (length > 0.0f) ? normal / length : normals[location.segment];
+}
+
+}}}
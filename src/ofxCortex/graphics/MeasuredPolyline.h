@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Snapshot of a polyline with prefix-summed arc lengths, segment directions and
+// vertex normals computed once. Every query at a length is then a binary search,
+// and the batched queries walk sorted lengths in a single pass. Closed polylines
+// wrap lengths around the perimeter, open ones clamp them to [0, getLength()].
+class MeasuredPolyline {
+public:
+  MeasuredPolyline() {};
+  MeasuredPolyline(const ofPolyline & source) { setup(source); };
+  
+  void setup(const ofPolyline & source);
+  
+  float getLength() const { return (lengths.empty()) ? 0.0f : lengths.back(); }
+  size_t size() const { return vertices.size(); }
+  bool isClosed() const { return closed; }
+  bool empty() const { return vertices.empty(); }
+  
+  // Fractional vertex index, as ofPolyline::getIndexAtLength
+  float getIndexAtLength(float length) const;
+  float getLengthAtIndex(size_t index) const { return (lengths.empty()) ? 0.0f : lengths[MIN(index, lengths.size() - 1)]; }
+  
+  glm::vec3 getPointAtLength(float length) const;
+  glm::vec3 getTangentAtLength(float length) const;
+  glm::vec3 getNormalAtLength(float length) const;
+  
+  glm::vec3 getPointAtPercent(float t) const { return getPointAtLength(t * getLength()); }
+  glm::vec3 getTangentAtPercent(float t) const { return getTangentAtLength(t * getLength()); }
+  glm::vec3 getNormalAtPercent(float t) const { return getNormalAtLength(t * getLength()); }
+  
+  // Part of the line between two lengths. On closed lines start > end wraps through the first vertex.
+  ofPolyline getSubsection(float start, float end) const;
+  ofPolyline getSubsectionAtPercent(float start, float end) const { return getSubsection(start * getLength(), end * getLength()); }
+  
+  // Batched queries, output[i] answers queries[i]. Ascending input is answered in one linear walk.
+  void getPointsAtLengths(const float * queries, size_t count, glm::vec3 * output) const;
+  void getPointsAtLengths(const std::vector<float> & queries, std::vector<glm::vec3> & output) const;
+  // Any of the frame outputs may be null.
+  void getFramesAtLengths(const float * queries, size_t count, glm::vec3 * outPoints, glm::vec3 * outTangents, glm::vec3 * outNormals) const;
+  
+  const std::vector<glm::vec3> & getVertices() const { return vertices; }
+
+protected:
+  std::vector<glm::vec3> vertices;
+  std::vector<float> lengths; // lengths[i] = arc length up to vertex i, plus the closing segment on closed lines
+  std::vector<glm::vec3> directions; // unit direction of segment i
+  std::vector<glm::vec3> normals; // per vertex, averaged over the adjacent segments
+  bool closed { false };
+  
+  struct Location {
+    size_t segment;
+    float t;
+  };
+  
+  float wrap(float length) const;
+  Location locate(float length) const;
+  Location locate(float length, size_t hint) const;
+  
+  glm::vec3 getPoint(const Location & location) const;
+  glm::vec3 getNormal(const Location & location) const;
+  size_t getEndVertex(size_t segment) const { return (segment + 1 < vertices.size()) ? segment + 1 : 0; }
+};
+
+}}}
@@ -0,0 +1,233 @@
+#include "OffsetShape.h"
+
+#include "ofxCortex/utils/HashUtils.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+void OffsetShape::setup(const std::vector<ofPolyline> & sources, JoinType jointype, EndType endtype, double miterLimit, double arcTolerance)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  
+  this->jointype = jointype;
+  this->endtype = endtype;
+  this->miterLimit = miterLimit;
+  this->arcTolerance = arcTolerance;
+  this->hash = getHash(sources, jointype, endtype, miterLimit, arcTolerance);
+  
+  // Scaled the same way as Clipper::getOffsets so results match it exactly
+  paths = Clipper::toClipper(sources, Clipper::DEFAULT_CLIPPER_SCALE);
+  
+  clipperOffset.Clear();
+  clipperOffset.MiterLimit = miterLimit * Clipper::DEFAULT_CLIPPER_SCALE;
+  clipperOffset.ArcTolerance = arcTolerance * Clipper::DEFAULT_CLIPPER_SCALE;
+  clipperOffset.AddPaths(paths, jointype, endtype);
+  
+  cache.clear();
+}
+
+OffsetShape::Lines OffsetShape::getOffset(float offset)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  
+  Lines cached = findCached(offset);
+  if (cached) return cached;
+  
+  return insertCached(offset, execute(clipperOffset, offset));
+}
+
+std::vector<ofPolyline> OffsetShape::getOffsets(const std::vector<float> & offsets)
+{
+  // Everything is gathered in `lines` first: with more offsets than the cache
+  // holds, the first ones would be evicted before the output is assembled
+  std::map<float, Lines> lines;
+  std::vector<float> missing;
+  
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (float offset : offsets)
+    {
+      if (lines.count(offset) != 0 || std::find(missing.begin(), missing.end(), offset) != missing.end()) continue;
+      
+      Lines cached = findCached(offset);
+      if (cached) lines[offset] = cached;
+      else missing.push_back(offset);
+    }
+  }
+  
+  if (missing.size() == 1)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lines[missing[0]] = insertCached(missing[0], execute(clipperOffset, missing[0]));
+  }
+  else if (missing.size() > 1)
+  {
+    // ClipperOffset keeps per-call state, so every chunk gets its own copy of the prepared paths
+    std::vector<std::vector<ofPolyline>> results(missing.size());
+    utils::Parallel::forRange(missing.size(), [&](size_t begin, size_t end) {
+      ClipperLib::ClipperOffset local(miterLimit * Clipper::DEFAULT_CLIPPER_SCALE, arcTolerance * Clipper::DEFAULT_CLIPPER_SCALE);
+      local.AddPaths(paths, jointype, endtype);
+      
+      for (size_t i = begin; i < end; i++) results[i] = execute(local, missing[i]);
+    });
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < missing.size(); i++) lines[missing[i]] = insertCached(missing[i], std::move(results[i]));
+  }
+  
+  std::vector<ofPolyline> output;
+  for (float offset : offsets)
+  {
+    const auto & offsetLines = *lines[offset];
+    output.insert(output.end(), offsetLines.begin(), offsetLines.end());
+  }
+  
+  return output;
+}
+
+void OffsetShape::clearCache()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  cache.clear();
+}
+
+void OffsetShape::setCacheSize(size_t maxOffsets)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  this->maxOffsets = std::max<size_t>(maxOffsets, 1);
+  evict(this->maxOffsets);
+}
+
+OffsetShape::Lines OffsetShape::findCached(float offset)
+{
+  auto it = cache.find(offset);
+  if (it == cache.end()) return nullptr;
+  
+  it->second.lastUse = ++useCount;
+  return it->second.lines;
+}
+
+OffsetShape::Lines OffsetShape::insertCached(float offset, std::vector<ofPolyline> && lines)
+{
+  if (cache.count(offset) == 0) evict(maxOffsets - 1);
+  
+  CacheEntry & entry = cache[offset];
+  entry.lines = std::make_shared<const std::vector<ofPolyline>>(std::move(lines));
+  entry.lastUse = ++useCount;
+  
+  return entry.lines;
+}
+
+void OffsetShape::evict(size_t maxSize)
+{
+  // The cache is a handful of entries, a linear search for the oldest is cheaper than keeping a list
+  while (cache.size() > maxSize)
+  {
+    auto oldest = std::min_element(cache.begin(), cache.end(), [](const auto & a, const auto & b) { return a.second.lastUse < b.second.lastUse; });
+    cache.erase(oldest);
+  }
+}
+
+std::vector<ofPolyline> OffsetShape::execute(ClipperLib::ClipperOffset & clipperOffset, float offset) const
+{
+  if (paths.empty()) return {};
+  
+  ClipperLib::Paths out;
+  clipperOffset.Execute(out, (double) offset * Clipper::DEFAULT_CLIPPER_SCALE);
+  
+  return Clipper::toOf(out, true, Clipper::DEFAULT_CLIPPER_SCALE);
+}
+
+uint64_t OffsetShape::getHash(const std::vector<ofPolyline> & sources, JoinType jointype, EndType endtype, double miterLimit, double arcTolerance)
+{
+  const int settings[2] = { (int) jointype, (int) endtype };
+  const double tolerances[2] = { miterLimit, arcTolerance };
+  
+  uint64_t hash = utils::hashBytes(settings, sizeof(settings));
+  hash = utils::hashBytes(tolerances, sizeof(tolerances), hash);
+  
+  return utils::hashVertices(sources, hash);
+}
+
+namespace {
+
+// Most recently used shape first
+struct SharedCache {
+  typedef std::list<std::pair<uint64_t, std::shared_ptr<OffsetShape>>> Shapes;
+  
+  std::mutex mutex;
+  Shapes shapes;
+  std::unordered_map<uint64_t, Shapes::iterator> index;
+  size_t maxShapes { 256 };
+  
+  // Expects the mutex to be held. Evicted shapes are moved to `evicted`, so they
+  // are destroyed after the lock is released.
+  void trim(size_t maxSize, Shapes & evicted)
+  {
+    while (shapes.size() > maxSize)
+    {
+      index.erase(shapes.back().first);
+      evicted.splice(evicted.end(), shapes, std::prev(shapes.end()));
+    }
+  }
+};
+
+SharedCache & getSharedCache()
+{
+  static SharedCache cache;
+  return cache;
+}
+
+}
+
+std::shared_ptr<OffsetShape> OffsetShape::getCached(const std::vector<ofPolyline> & sources, JoinType jointype, EndType endtype)
+{
+  const uint64_t hash = getHash(sources, jointype, endtype);
+  SharedCache & shared = getSharedCache();
+  
+  {
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto it = shared.index.find(hash);
+    if (it != shared.index.end())
+    {
+      shared.shapes.splice(shared.shapes.begin(), shared.shapes, it->second);
+      return it->second->second;
+    }
+  }
+  
+  auto shape = std::make_shared<OffsetShape>(sources, jointype, endtype);
+  SharedCache::Shapes evicted;
+  
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  
+  // Another thread may have prepared the same shape in the meantime
+  auto it = shared.index.find(hash);
+  if (it != shared.index.end()) return it->second->second;
+  
+  shared.trim(shared.maxShapes - 1, evicted);
+  shared.shapes.emplace_front(hash, shape);
+  shared.index[hash] = shared.shapes.begin();
+  
+  return shape;
+}
+
+void OffsetShape::clearSharedCache()
+{
+  SharedCache & shared = getSharedCache();
+  SharedCache::Shapes evicted;
+  
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  shared.trim(0, evicted);
+}
+
+void OffsetShape::setSharedCacheSize(size_t maxShapes)
+{
+  SharedCache & shared = getSharedCache();
+  SharedCache::Shapes evicted;
+  
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  shared.maxShapes = std::max<size_t>(maxShapes, 1);
+  shared.trim(shared.maxShapes, evicted);
+}
+
+}}}
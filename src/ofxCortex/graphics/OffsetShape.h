@@ -0,0 +1,88 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <memory>
+
+#include "ofxClipper.h"
+
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Polylines converted to Clipper's integer paths once, ready to be offset any
+// number of times. Keeps one ClipperOffset around for serial calls and caches
+// the offsets it produced, so concentric contours and per-frame redraws of
+// the same shape skip both the conversion and the offsetting. The cache holds
+// the most recently used offsets only, so an animated offset does not keep
+// every value it went through.
+class OffsetShape {
+public:
+  typedef ClipperLib::JoinType JoinType;
+  typedef ClipperLib::EndType EndType;
+  typedef std::shared_ptr<const std::vector<ofPolyline>> Lines;
+  
+  OffsetShape() {};
+  OffsetShape(const ofPolyline & source, JoinType jointype = ClipperLib::jtSquare, EndType endtype = ClipperLib::etOpenSquare, double miterLimit = Clipper::DEFAULT_MITER_LIMIT, double arcTolerance = Clipper::DEFAULT_ARC_TOLERANCE) { setup(std::vector<ofPolyline>{ source }, jointype, endtype, miterLimit, arcTolerance); };
+  OffsetShape(const std::vector<ofPolyline> & sources, JoinType jointype = ClipperLib::jtSquare, EndType endtype = ClipperLib::etOpenSquare, double miterLimit = Clipper::DEFAULT_MITER_LIMIT, double arcTolerance = Clipper::DEFAULT_ARC_TOLERANCE) { setup(sources, jointype, endtype, miterLimit, arcTolerance); };
+  
+  OffsetShape(const OffsetShape &) = delete;
+  OffsetShape & operator=(const OffsetShape &) = delete;
+  
+  void setup(const std::vector<ofPolyline> & sources, JoinType jointype = ClipperLib::jtSquare, EndType endtype = ClipperLib::etOpenSquare, double miterLimit = Clipper::DEFAULT_MITER_LIMIT, double arcTolerance = Clipper::DEFAULT_ARC_TOLERANCE);
+  
+  // Same output as Clipper::getOffsets(sources, offset, ...). The lines are shared
+  // with the cache and stay valid after it drops them.
+  Lines getOffset(float offset);
+  
+  // All offsets back to back, in the order given. Uncached offsets run in parallel.
+  std::vector<ofPolyline> getOffsets(const std::vector<float> & offsets);
+  
+  void clearCache();
+  
+  // Number of offsets kept per shape, the least recently used one is dropped first
+  void setCacheSize(size_t maxOffsets);
+  size_t getCacheSize() const { return maxOffsets; }
+  
+  uint64_t getHash() const { return hash; }
+  bool empty() const { return paths.empty(); }
+  
+  // FNV-1a over the vertices, closed flags and offset settings, for keying caches of shapes
+  static uint64_t getHash(const std::vector<ofPolyline> & sources, JoinType jointype, EndType endtype, double miterLimit = Clipper::DEFAULT_MITER_LIMIT, double arcTolerance = Clipper::DEFAULT_ARC_TOLERANCE);
+  
+  // Shared cache of prepared shapes keyed by getHash(), dropping the least recently
+  // used shape when full. Used by Line::drawPolyline / getLinePath, which redraw
+  // the same shapes every frame; one-off offsets should not go through it.
+  static std::shared_ptr<OffsetShape> getCached(const std::vector<ofPolyline> & sources, JoinType jointype, EndType endtype);
+  static void clearSharedCache();
+  static void setSharedCacheSize(size_t maxShapes);
+
+protected:
+  ClipperLib::Paths paths;
+  ClipperLib::ClipperOffset clipperOffset;
+  JoinType jointype { ClipperLib::jtSquare };
+  EndType endtype { ClipperLib::etOpenSquare };
+  double miterLimit { Clipper::DEFAULT_MITER_LIMIT };
+  double arcTolerance { Clipper::DEFAULT_ARC_TOLERANCE };
+  uint64_t hash { 0 };
+  
+  struct CacheEntry {
+    Lines lines;
+    uint64_t lastUse { 0 };
+  };
+  
+  std::mutex mutex;
+  std::map<float, CacheEntry> cache;
+  size_t maxOffsets { 16 };
+  uint64_t useCount { 0 };
+  
+  std::vector<ofPolyline> execute(ClipperLib::ClipperOffset & clipperOffset, float offset) const;
+  
+  // Expects the mutex to be held
+  Lines findCached(float offset);
+  Lines insertCached(float offset, std::vector<ofPolyline> && lines);
+  void evict(size_t maxSize);
+};
+
+}}}
@@ -0,0 +1,380 @@
+#include "PathOptimizer.h"
+
+#include <chrono>
+#include <numeric>
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+namespace {
+
+// A vertex the pen may go down on
+struct Candidate {
+  glm::vec2 position;
+  unsigned int line;
+  unsigned int vertex;
+};
+
+// Uniform grid over the candidates, stored back to back per cell, with O(1) removal
+class CandidateGrid {
+public:
+  CandidateGrid(const std::vector<Candidate> & candidates) : candidates(candidates), slots(candidates.size(), EMPTY) {}
+  
+  void build(const std::vector<unsigned int> & live)
+  {
+    std::fill(slots.begin(), slots.end(), EMPTY);
+    numLive = numBuilt = live.size();
+    if (live.empty()) return;
+    
+    glm::vec2 min { std::numeric_limits<float>::max() };
+    glm::vec2 max { std::numeric_limits<float>::lowest() };
+    for (unsigned int id : live)
+    {
+      min = glm::min(min, candidates[id].position);
+      max = glm::max(max, candidates[id].position);
+    }
+    
+    // About two candidates per cell
+    const glm::vec2 size = glm::max(max - min, glm::vec2(1e-3f));
+    cellSize = MAX(sqrt(size.x * size.y * 2.0f / live.size()), 1e-3f);
+    columns = CLAMP((int) (size.x / cellSize) + 1, 1, 4096);
+    rows = CLAMP((int) (size.y / cellSize) + 1, 1, 4096);
+    cellSize = MAX(size.x / columns, size.y / rows) * 1.0001f;
+    origin = min;
+    
+    cellStart.assign(columns * rows + 1, 0);
+    for (unsigned int id : live) cellStart[getCell(candidates[id].position) + 1]++;
+    for (size_t i = 1; i < cellStart.size(); i++) cellStart[i] += cellStart[i - 1];
+    
+    cellCount.assign(columns * rows, 0);
+    items.resize(live.size());
+    for (unsigned int id : live)
+    {
+      const int cell = getCell(candidates[id].position);
+      const unsigned int slot = cellStart[cell] + cellCount[cell]++;
+      items[slot] = id;
+      slots[id] = slot;
+    }
+  }
+  
+  void remove(unsigned int id)
+  {
+    const unsigned int slot = slots[id];
+    if (slot == EMPTY) return;
+    
+    // Swap with the last live item of the cell
+    const int cell = getCell(candidates[id].position);
+    const unsigned int last = cellStart[cell] + --cellCount[cell];
+    
+    items[slot] = items[last];
+    slots[items[slot]] = slot;
+    items[last] = id;
+    slots[id] = EMPTY;
+    
+    numLive--;
+  }
+  
+  // Closest live candidate, or -1 when none is left
+  int findNearest(const glm::vec2 & position) const
+  {
+    if (numLive == 0) return -1;
+    
+    const int cx = CLAMP((int) floor((position.x - origin.x) / cellSize), 0, columns - 1);
+    const int cy = CLAMP((int) floor((position.y - origin.y) / cellSize), 0, rows - 1);
+    
+    int best = -1;
+    float bestDistance = std::numeric_limits<float>::max();
+    
+    auto visit = [&](int x, int y) {
+      if (x < 0 || y < 0 || x >= columns || y >= rows) return;
+      
+      const int cell = y * columns + x;
+      for (unsigned int i = cellStart[cell], end = cellStart[cell] + cellCount[cell]; i < end; i++)
+      {
+        const float distance = glm::distance2(position, candidates[items[i]].position);
+        if (distance < bestDistance) { bestDistance = distance; best = items[i]; }
+      }
+    };
+    
+    // Rings of cells around the start cell; ring r is at least (r - 1) cells away
+    for (int r = 0, maxRing = MAX(columns, rows); r <= maxRing; r++)
+    {
+      if (best >= 0 && bestDistance <= (r - 1) * cellSize * (r - 1) * cellSize) break;
+      
+      for (int y = cy - r; y <= cy + r; y++)
+      {
+        if (y == cy - r || y == cy + r) { for (int x = cx - r; x <= cx + r; x++) visit(x, y); }
+        else { visit(cx - r, y); if (r > 0) visit(cx + r, y); }
+      }
+    }
+    
+    return best;
+  }
+  
+  size_t getNumLive() const { return numLive; }
+  size_t getNumBuilt() const { return numBuilt; }
+
+private:
+  static constexpr unsigned int EMPTY = std::numeric_limits<unsigned int>::max();
+  
+  const std::vector<Candidate> & candidates;
+  std::vector<unsigned int> slots; // per candidate, position in items
+  std::vector<unsigned int> items;
+  std::vector<unsigned int> cellStart;
+  std::vector<unsigned int> cellCount;
+  
+  glm::vec2 origin;
+  float cellSize { 1.0f };
+  int columns { 1 };
+  int rows { 1 };
+  size_t numLive { 0 };
+  size_t numBuilt { 0 };
+  
+  int getCell(const glm::vec2 & p) const
+  {
+    const int x = CLAMP((int) ((p.x - origin.x) / cellSize), 0, columns - 1);
+    const int y = CLAMP((int) ((p.y - origin.y) / cellSize), 0, rows - 1);
+    return y * columns + x;
+  }
+};
+
+float getMillis(const std::chrono::steady_clock::time_point & since)
+{
+  return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+}
+
+std::vector<PathOptimizer::Step> PathOptimizer::getOrder(const std::vector<ofPolyline> & lines, const Settings & settings, Stats * stats)
+{
+  auto time = std::chrono::steady_clock::now();
+  
+  auto isLoop = [](const ofPolyline & line) { return line.isClosed() && line.size() > 1; };
+  
+  // Every vertex a line can be entered from, grouped per line
+  std::vector<Candidate> candidates;
+  std::vector<unsigned int> lineStart(lines.size() + 1, 0);
+  
+  for (unsigned int i = 0; i < lines.size(); i++)
+  {
+    const auto & vertices = lines[i].getVertices();
+    lineStart[i] = candidates.size();
+    if (vertices.empty()) continue;
+    
+    if (isLoop(lines[i]) && settings.allowRestart)
+    {
+      for (unsigned int v = 0; v < vertices.size(); v++) candidates.push_back({ vertices[v], i, v });
+    }
+    else
+    {
+      candidates.push_back({ vertices.front(), i, 0 });
+      if (settings.allowReverse && !isLoop(lines[i]) && vertices.size() > 1) candidates.push_back({ vertices.back(), i, (unsigned int) vertices.size() - 1 });
+    }
+  }
+  lineStart[lines.size()] = candidates.size();
+  
+  std::vector<unsigned int> live(candidates.size());
+  std::iota(live.begin(), live.end(), 0);
+  
+  CandidateGrid grid(candidates);
+  grid.build(live);
+  
+  // Greedy: always go to the closest free entry point
+  std::vector<Step> order;
+  std::vector<glm::vec2> entries, exits;
+  std::vector<bool> used(lines.size(), false);
+  
+  order.reserve(lines.size());
+  entries.reserve(lines.size());
+  exits.reserve(lines.size());
+  
+  glm::vec2 pen = settings.home;
+  for (int id = grid.findNearest(pen); id >= 0; id = grid.findNearest(pen))
+  {
+    const Candidate & candidate = candidates[id];
+    const auto & vertices = lines[candidate.line].getVertices();
+    const bool loop = isLoop(lines[candidate.line]);
+    const bool reversed = !loop && candidate.vertex != 0;
+    
+    order.push_back({ candidate.line, candidate.vertex, reversed });
+    entries.push_back(candidate.position);
+    exits.push_back((loop) ? candidate.position : (reversed) ? glm::vec2(vertices.front()) : glm::vec2(vertices.back()));
+    used[candidate.line] = true;
+    pen = exits.back();
+    
+    for (unsigned int i = lineStart[candidate.line]; i < lineStart[candidate.line + 1]; i++) grid.remove(i);
+    
+    // Shrink the grid once most of it is empty, so late searches do not crawl through empty cells
+    if (grid.getNumBuilt() > 1024 && grid.getNumLive() * 4 < grid.getNumBuilt())
+    {
+      live.clear();
+      for (unsigned int i = 0; i < candidates.size(); i++) if (!used[candidates[i].line]) live.push_back(i);
+      grid.build(live);
+    }
+  }
+  
+  if (stats) stats->greedyMillis = getMillis(time);
+  time = std::chrono::steady_clock::now();
+  
+  // Windowed 2-opt: reversing a run of steps swaps the entry and exit of each of them,
+  // which open lines only allow when they may be drawn backwards. Otherwise single
+  // steps are moved elsewhere in the window instead (or-opt), which keeps their direction.
+  size_t improvements = 0;
+  const size_t len = order.size();
+  const size_t window = MAX(settings.window, 1);
+  const bool canReverse = settings.allowReverse || std::none_of(order.begin(), order.end(), [&](const Step & step) { return !isLoop(lines[step.index]); });
+  
+  // Pen-up distance from step `from` (-1 is home) to step `to`, nothing after the last step
+  auto link = [&](ptrdiff_t from, ptrdiff_t to) {
+    if (to >= (ptrdiff_t) len) return 0.0f;
+    return glm::distance((from < 0) ? settings.home : exits[from], entries[to]);
+  };
+  
+  auto twoOpt = [&](size_t i) {
+    const glm::vec2 & before = (i == 0) ? settings.home : exits[i - 1];
+    const float current = glm::distance(before, entries[i]);
+    
+    for (size_t j = i + 1; j < MIN(len, i + 1 + window); j++)
+    {
+      const bool last = j + 1 == len;
+      const float removed = current + ((last) ? 0.0f : glm::distance(exits[j], entries[j + 1]));
+      const float added = glm::distance(before, exits[j]) + ((last) ? 0.0f : glm::distance(entries[i], entries[j + 1]));
+      
+      if (added < removed - 1e-4f)
+      {
+        std::reverse(order.begin() + i, order.begin() + j + 1);
+        std::reverse(entries.begin() + i, entries.begin() + j + 1);
+        std::reverse(exits.begin() + i, exits.begin() + j + 1);
+        
+        for (size_t k = i; k <= j; k++)
+        {
+          std::swap(entries[k], exits[k]);
+          if (!isLoop(lines[order[k].index]))
+          {
+            order[k].reversed = !order[k].reversed;
+            order[k].start = (order[k].reversed) ? lines[order[k].index].size() - 1 : 0;
+          }
+        }
+        
+        return true;
+      }
+    }
+    
+    return false;
+  };
+  
+  auto orOpt = [&](size_t i) {
+    const ptrdiff_t step = i;
+    const float removed = link(step - 1, step) + link(step, step + 1) - link(step - 1, step + 1);
+    
+    // Goes between steps k and k + 1; k = i - 1 and k = i leave it where it is
+    const ptrdiff_t first = MAX(step - 1 - (ptrdiff_t) window, (ptrdiff_t) -1);
+    const ptrdiff_t last = MIN(step + (ptrdiff_t) window, (ptrdiff_t) len - 1);
+    
+    for (ptrdiff_t k = first; k <= last; k++)
+    {
+      if (k == step - 1 || k == step) continue;
+      
+      const float added = link(k, step) + link(step, k + 1) - link(k, k + 1);
+      
+      if (added < removed - 1e-4f)
+      {
+        auto move = [&](auto & steps) {
+          if (k > step) std::rotate(steps.begin() + step, steps.begin() + step + 1, steps.begin() + k + 1);
+          else std::rotate(steps.begin() + k + 1, steps.begin() + step, steps.begin() + step + 1);
+        };
+        move(order);
+        move(entries);
+        move(exits);
+        
+        return true;
+      }
+    }
+    
+    return false;
+  };
+  
+  if (settings.maxMillis > 0.0f && len > 2)
+  {
+    bool improved = true;
+    bool outOfTime = false;
+    size_t checks = 0;
+    
+    // A move at i only changes the links from i - window on, so the scan steps back that
+    // far and carries on instead of starting over; passes repeat while one still improves
+    while (improved && !outOfTime)
+    {
+      improved = false;
+      for (size_t i = 0; i < len; i++)
+      {
+        if ((++checks & 255) == 0 && getMillis(time) >= settings.maxMillis) { outOfTime = true; break; }
+        
+        if ((canReverse) ? twoOpt(i) : orOpt(i))
+        {
+          improvements++;
+          improved = true;
+          i = (i > window) ? i - window - 1 : (size_t) -1;
+        }
+      }
+    }
+  }
+  
+  // Empty lines have nothing to draw, they go last
+  for (size_t i = 0; i < lines.size(); i++) if (!used[i]) order.push_back({ i, 0, false });
+  
+  if (stats)
+  {
+    stats->refineMillis = getMillis(time);
+    stats->improvements = improvements;
+    stats->travelBefore = getTravel(lines, settings.home);
+    
+    double travel = 0.0;
+    for (size_t i = 0; i < len; i++) travel += glm::distance((i == 0) ? settings.home : exits[i - 1], entries[i]);
+    stats->travelAfter = travel;
+  }
+  
+  return order;
+}
+
+std::vector<ofPolyline> PathOptimizer::optimize(const std::vector<ofPolyline> & lines, const Settings & settings, Stats * stats)
+{
+  std::vector<ofPolyline> output;
+  apply(lines, getOrder(lines, settings, stats), output);
+  return output;
+}
+
+void PathOptimizer::apply(const std::vector<ofPolyline> & lines, const std::vector<Step> & order, std::vector<ofPolyline> & output)
+{
+  output.resize(order.size());
+  
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    const Step & step = order[i];
+    const auto & vertices = lines[step.index].getVertices();
+    auto & result = output[i].getVertices();
+    
+    result.assign(vertices.begin(), vertices.end());
+    if (step.reversed) std::reverse(result.begin(), result.end());
+    else if (step.start > 0 && step.start < result.size()) std::rotate(result.begin(), result.begin() + step.start, result.end());
+    
+    output[i].setClosed(lines[step.index].isClosed());
+    output[i].flagHasChanged();
+  }
+}
+
+double PathOptimizer::getTravel(const std::vector<ofPolyline> & lines, const glm::vec2 & home)
+{
+  double travel = 0.0;
+  glm::vec2 pen = home;
+  
+  for (const auto & line : lines)
+  {
+    if (line.size() == 0) continue;
+    
+    travel += glm::distance(pen, glm::vec2(line[0]));
+    pen = (line.isClosed()) ? line[0] : line[line.size() - 1];
+  }
+  
+  return travel;
+}
+
+}}}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Reorders polylines for pen plotters so the pen travels as little as possible
+// between strokes. A greedy pass always moves to the nearest free stroke end
+// (found through a uniform grid, so it stays fast on 100k+ strokes), then a
+// windowed 2-opt pass untangles the order until the time budget runs out.
+// Open lines may be drawn backwards and closed ones may start at any vertex.
+// 2-opt draws the steps it reorders backwards, so when open lines have to keep
+// their direction the refinement moves single strokes to a better place instead.
+class PathOptimizer {
+public:
+  struct Settings {
+    bool allowReverse { true };
+    bool allowRestart { true }; // closed polylines may start at their vertex nearest to the pen
+    float maxMillis { 100.0f }; // time budget of the refinement, 0 keeps the greedy order
+    int window { 32 }; // how many steps away the refinement looks for a better connection, at least 1
+    glm::vec2 home { 0.0f, 0.0f }; // where the pen starts
+  };
+  
+  struct Step {
+    size_t index; // into the source polylines
+    size_t start; // vertex the pen goes down on
+    bool reversed;
+  };
+  
+  struct Stats {
+    double travelBefore { 0.0 }; // pen-up distance in the original order
+    double travelAfter { 0.0 };
+    float greedyMillis { 0.0f };
+    float refineMillis { 0.0f };
+    size_t improvements { 0 }; // refinement moves applied
+  };
+  
+  static std::vector<Step> getOrder(const std::vector<ofPolyline> & lines, const Settings & settings, Stats * stats = nullptr);
+  
+  // Polylines in drawing order, reversed and rotated to start where the pen goes down
+  static std::vector<ofPolyline> optimize(const std::vector<ofPolyline> & lines, const Settings & settings, Stats * stats = nullptr);
+  static void apply(const std::vector<ofPolyline> & lines, const std::vector<Step> & order, std::vector<ofPolyline> & output);
+  
+  // Pen-up distance to draw `lines` as they are, starting from `home`
+  static double getTravel(const std::vector<ofPolyline> & lines, const glm::vec2 & home = glm::vec2(0.0f));
+};
+
+}}}
@@ -0,0 +1,135 @@
+#include "PolylineMorph.h"
+
+#include "MeasuredPolyline.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Outputs are written as one float array straight into the polyline's vertices
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 is expected to be tightly packed");
+
+void PolylineMorph::setup(const ofPolyline & source, const ofPolyline & target, size_t resolution)
+{
+  closed = source.isClosed() && target.isClosed();
+  
+  const size_t count = MAX((resolution > 0) ? resolution : MAX(source.size(), target.size()), (size_t) 2);
+  
+  std::vector<glm::vec3> a, b;
+  resample(source, count, closed, a);
+  resample(target, count, closed, b);
+  
+  if (closed)
+  {
+    // Same winding, then the rotation that keeps corresponding points closest
+    const float areaA = getSignedArea(a);
+    const float areaB = getSignedArea(b);
+    if (areaA * areaB < 0.0f) std::reverse(b.begin() + 1, b.end());
+    
+    std::rotate(b.begin(), b.begin() + getBestRotation(a, b), b.end());
+  }
+  else
+  {
+    const float straight = glm::distance2(a.front(), b.front()) + glm::distance2(a.back(), b.back());
+    const float flipped = glm::distance2(a.front(), b.back()) + glm::distance2(a.back(), b.front());
+    if (flipped < straight) std::reverse(b.begin(), b.end());
+  }
+  
+  from.resize(count * 3);
+  delta.resize(count * 3);
+  
+  for (size_t i = 0; i < count; i++)
+  {
+    for (int axis = 0; axis < 3; axis++)
+    {
+      from[i * 3 + axis] = a[i][axis];
+      delta[i * 3 + axis] = b[i][axis] - a[i][axis];
+    }
+  }
+}
+
+void PolylineMorph::getInterpolated(float t, ofPolyline & output) const
+{
+  auto & vertices = output.getVertices();
+  vertices.resize(size());
+  
+  // Plain float loop over contiguous arrays, left to the compiler to vectorise
+  if (!vertices.empty())
+  {
+    float * out = &vertices[0].x;
+    const float * a = from.data();
+    const float * d = delta.data();
+    const size_t len = from.size();
+    
+    for (size_t i = 0; i < len; i++) out[i] = a[i] + d[i] * t;
+  }
+  
+  output.setClosed(closed);
+  output.flagHasChanged();
+}
+
+ofPolyline PolylineMorph::getInterpolated(float t) const
+{
+  ofPolyline output;
+  getInterpolated(t, output);
+  return output;
+}
+
+void PolylineMorph::getInterpolated(const PolylineMorph * morphs, size_t count, ofPolyline * output, float t)
+{
+  utils::Parallel::forEach(count, [&](size_t i) { morphs[i].getInterpolated(t, output[i]); });
+}
+
+void PolylineMorph::getInterpolated(const PolylineMorph * morphs, size_t count, ofPolyline * output, const float * t)
+{
+  utils::Parallel::forEach(count, [&](size_t i) { morphs[i].getInterpolated(t[i], output[i]); });
+}
+
+void PolylineMorph::getInterpolated(const std::vector<PolylineMorph> & morphs, std::vector<ofPolyline> & output, float t)
+{
+  output.resize(morphs.size());
+  getInterpolated(morphs.data(), morphs.size(), output.data(), t);
+}
+
+void PolylineMorph::resample(const ofPolyline & source, size_t count, bool closed, std::vector<glm::vec3> & output)
+{
+  const MeasuredPolyline measured(source);
+  
+  // Closed morphs spread the points over the whole perimeter, open ones include both ends.
+  // A closed source in an open morph wraps its last point back onto the first.
+  const float step = measured.getLength() / ((closed) ? count : count - 1);
+  
+  std::vector<float> lengths(count);
+  for (size_t i = 0; i < count; i++) lengths[i] = step * i;
+  if (!closed && !measured.isClosed()) lengths.back() = measured.getLength();
+  
+  measured.getPointsAtLengths(lengths, output);
+}
+
+float PolylineMorph::getSignedArea(const std::vector<glm::vec3> & points)
+{
+  float area = 0.0f;
+  for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) area += points[j].x * points[i].y - points[i].x * points[j].y;
+  return area * 0.5f;
+}
+
+size_t PolylineMorph::getBestRotation(const std::vector<glm::vec3> & source, const std::vector<glm::vec3> & target)
+{
+  // Every rotation is scored on at most 64 evenly spread points, which keeps this linear in the point count
+  const size_t len = source.size();
+  const size_t stride = MAX(len / 64, (size_t) 1);
+  
+  size_t best = 0;
+  float bestCost = std::numeric_limits<float>::max();
+  
+  for (size_t shift = 0; shift < len; shift++)
+  {
+    float cost = 0.0f;
+    for (size_t i = 0; i < len && cost < bestCost; i += stride) cost += glm::distance2(source[i], target[(i + shift) % len]);
+    
+    if (cost < bestCost) { bestCost = cost; best = shift; }
+  }
+  
+  return best;
+}
+
+}}}
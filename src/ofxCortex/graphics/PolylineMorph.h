@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace graphics {
+
+// Morph between two polylines of any vertex count. setup() resamples both by arc
+// length to the same number of points once, matches their winding and rotates
+// the target so closed shapes start at corresponding points (open lines are
+// flipped if that brings their ends closer). The pair is then kept as flat
+// float arrays, and every frame is a single lerp into a reusable output.
+//
+//   PolylineMorph morph(circle, star);
+//   morph.getInterpolated(t, output); // no allocation once `output` is big enough
+class PolylineMorph {
+public:
+  PolylineMorph() {};
+  PolylineMorph(const ofPolyline & from, const ofPolyline & to, size_t resolution = 0) { setup(from, to, resolution); };
+  
+  // `resolution` is the number of points of the morph, 0 uses the larger of the two vertex counts
+  void setup(const ofPolyline & from, const ofPolyline & to, size_t resolution = 0);
+  
+  void getInterpolated(float t, ofPolyline & output) const;
+  ofPolyline getInterpolated(float t) const;
+  
+  size_t size() const { return from.size() / 3; }
+  bool isClosed() const { return closed; }
+  bool empty() const { return from.empty(); }
+  
+  // Batch interpolation on utils::Parallel's shared pool, output[i] is morphs[i] at t (or at t[i])
+  static void getInterpolated(const PolylineMorph * morphs, size_t count, ofPolyline * output, float t);
+  static void getInterpolated(const PolylineMorph * morphs, size_t count, ofPolyline * output, const float * t);
+  static void getInterpolated(const std::vector<PolylineMorph> & morphs, std::vector<ofPolyline> & output, float t);
+
+protected:
+  std::vector<float> from; // x, y, z of every point
+  std::vector<float> delta; // to - from, so a frame is from + delta * t
+  bool closed { false };
+  
+  static void resample(const ofPolyline & source, size_t count, bool closed, std::vector<glm::vec3> & output);
+  static float getSignedArea(const std::vector<glm::vec3> & points);
+  static size_t getBestRotation(const std::vector<glm::vec3> & source, const std::vector<glm::vec3> & target);
+};
+
+}}}
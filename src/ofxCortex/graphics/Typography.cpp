@@ -149,13 +149,17 @@ void Typography::typeOnPath(const ofTrueTypeFont & font, const std::string & tex
   
   float totalWidth = ((xBB.width * scale) * (1.0 + spacing)) * text.size();
   
-  offset = ofWrap(offset - (totalWidth * horzAlignMultipliers[horizontalAlign]), 0, line.getPerimeter());
+  // Measured once, every letter below is placed with a binary search
+  MeasuredPolyline measured(line);
+  const float perimeter = measured.getLength();
+  
+  offset = ofWrap(offset - (totalWidth * horzAlignMultipliers[horizontalAlign]), 0, perimeter);
   
   int letterIndex = 0;
-  for (float lineX = 0; abs(lineX) < line.getPerimeter() - xBB.width * scale;)
+  for (float lineX = 0; abs(lineX) < perimeter - xBB.width * scale;)
   {
     if (letterIndex > text.size() - 1 && !repeat) break;
-    if (!wrap && lineX + offset > line.getPerimeter()) break;
+    if (!wrap && lineX + offset > perimeter) break;
     
     string letter = ofToString(text[letterIndex % text.size()]);
     bool isSpace = text[letterIndex % text.size()] == ' ';
@@ -164,12 +168,10 @@ void Typography::typeOnPath(const ofTrueTypeFont & font, const std::string & tex
     auto scaledBB = BB; scaledBB.scale(scale);
     
     float actualX = lineX + offset;
-    float wrappedX = ofWrap(actualX, 0, line.getPerimeter());
-    
-    float index = line.getIndexAtLength(wrappedX);
+    float wrappedX = ofWrap(actualX, 0, perimeter);
     
-    glm::vec3 pos = line.getPointAtIndexInterpolated(index);
-    float rot = utils::Vector::toRadians(line.getNormalAtIndexInterpolated(index + 0.000001)) + HALF_PI;
+    glm::vec3 pos = measured.getPointAtLength(wrappedX);
+    float rot = utils::Vector::toRadians(measured.getNormalAtLength(wrappedX)) + HALF_PI;
     
     ofPushMatrix();
     ofTranslate(pos);
@@ -3,6 +3,7 @@
 #include "ofMain.h"
 #include "ofTrueTypeFont.h"
 #include "ofxCortex/utils/VectorUtils.h"
+#include "ofxCortex/graphics/MeasuredPolyline.h"
 
 namespace ofxCortex { namespace core { namespace graphics {
 
@@ -0,0 +1,631 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofPolyline.h"
+#include "ofRectangle.h"
+
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace spatial {
+
+// Delaunay triangulation of 2D points with a sweep-hull (after delaunator,
+// github.com/mapbox/delaunator): points are inserted in order of distance
+// from a seed triangle, so each one lands next to the current convex hull,
+// which is found through a hash on the angle around the seed. Everything is
+// stored in flat index arrays as half-edges: half-edge e belongs to triangle
+// e / 3, runs from point triangles[e] to triangles[next(e)], and
+// halfedges[e] is the same edge seen from the neighbouring triangle.
+//
+// Voronoi cells are derived from the half-edges: the cell of a point is the
+// clip rectangle cut by the bisectors of its Delaunay neighbours. Lloyd
+// relaxation computes the cells across utils::Parallel's pool.
+//
+//   Delaunay delaunay(PoissonDisc::sample(4.0f, bounds));
+//   delaunay.relax(bounds, 4);
+//   for (const auto & cell : delaunay.getVoronoiCells(bounds)) cell.draw();
+class Delaunay {
+public:
+  static constexpr unsigned int EMPTY = std::numeric_limits<unsigned int>::max();
+  
+  Delaunay() = default;
+  Delaunay(const std::vector<glm::vec2> & points) { setup(points); }
+  
+  void setup(const std::vector<glm::vec2> & points)
+  {
+    this->points = points;
+    triangulate();
+  }
+  
+  const std::vector<glm::vec2> & getPoints() const { return points; }
+  
+  // Three point indices per triangle, all wound the same way
+  const std::vector<unsigned int> & getTriangles() const { return triangles; }
+  
+  // Opposite half-edge of each half-edge, EMPTY on the convex hull
+  const std::vector<unsigned int> & getHalfedges() const { return halfedges; }
+  
+  // Point indices along the convex hull
+  const std::vector<unsigned int> & getHull() const { return hull; }
+  
+  // A half-edge ending at each point (the hull one for hull points), EMPTY for duplicates
+  // that were left out of the triangulation
+  const std::vector<unsigned int> & getInedges() const { return inedges; }
+  
+  size_t getNumTriangles() const { return triangles.size() / 3; }
+  
+  static unsigned int nextHalfedge(unsigned int e) { return (e % 3 == 2) ? e - 2 : e + 1; }
+  static unsigned int prevHalfedge(unsigned int e) { return (e % 3 == 0) ? e + 2 : e - 1; }
+  
+  // Calls func(neighbour, halfedge) for the points sharing an edge with point `i`, in
+  // winding order; `halfedge` runs from the neighbour to `i`
+  template<typename Func>
+  void forEachNeighbour(unsigned int i, Func && func) const
+  {
+    const unsigned int start = inedges[i];
+    if (start == EMPTY) return;
+    
+    unsigned int e = start;
+    do {
+      func(triangles[e], e);
+      const unsigned int outgoing = nextHalfedge(e);
+      e = halfedges[outgoing];
+      
+      // Hull points end on an outgoing hull edge, whose far end is a neighbour too
+      if (e == EMPTY) { func(triangles[nextHalfedge(outgoing)], outgoing); break; }
+    } while (e != start);
+  }
+  
+  std::vector<unsigned int> getNeighbours(unsigned int i) const
+  {
+    std::vector<unsigned int> neighbours;
+    forEachNeighbour(i, [&neighbours](unsigned int j, unsigned int) { neighbours.push_back(j); });
+    return neighbours;
+  }
+  
+  // The Voronoi vertices
+  glm::vec2 getCircumcenter(size_t triangle) const
+  {
+    const unsigned int * t = &triangles[triangle * 3];
+    return glm::vec2(getCircumcenter(coords[t[0] * 2], coords[t[0] * 2 + 1], coords[t[1] * 2], coords[t[1] * 2 + 1], coords[t[2] * 2], coords[t[2] * 2 + 1]));
+  }
+  
+  std::vector<glm::vec2> getCircumcenters() const
+  {
+    std::vector<glm::vec2> centers(getNumTriangles());
+    utils::Parallel::forRange(centers.size(), [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; t++) centers[t] = getCircumcenter(t);
+    }, 1024);
+    return centers;
+  }
+  
+  // Indexed OF_PRIMITIVE_TRIANGLES mesh of the triangulation
+  ofMesh getMesh() const
+  {
+    ofMesh mesh;
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    
+    auto & vertices = mesh.getVertices();
+    vertices.reserve(points.size());
+    for (const auto & point : points) vertices.emplace_back(point.x, point.y, 0.0f);
+    
+    mesh.getIndices().assign(triangles.begin(), triangles.end());
+    return mesh;
+  }
+  
+  // Voronoi cell of point `i` clipped to `bounds`, empty for duplicates
+  ofPolyline getVoronoiCell(unsigned int i, const ofRectangle & bounds) const
+  {
+    std::vector<glm::dvec2> cell, scratch;
+    clipCell(i, bounds, cell, scratch);
+    
+    ofPolyline polyline;
+    for (const auto & vertex : cell) polyline.addVertex(vertex.x, vertex.y);
+    polyline.close();
+    return polyline;
+  }
+  
+  std::vector<ofPolyline> getVoronoiCells(const ofRectangle & bounds) const
+  {
+    const std::vector<glm::dvec2> centers = getVoronoiVertices();
+    
+    std::vector<ofPolyline> cells(points.size());
+    utils::Parallel::forRange(points.size(), [&](size_t begin, size_t end) {
+      std::vector<glm::dvec2> cell, scratch;
+      for (size_t i = begin; i < end; i++)
+      {
+        getCell(i, bounds, centers, cell, scratch);
+        for (const auto & vertex : cell) cells[i].addVertex(vertex.x, vertex.y);
+        cells[i].close();
+      }
+    }, 256);
+    return cells;
+  }
+  
+  // Centroids of the clipped Voronoi cells, duplicates keep their position
+  std::vector<glm::vec2> getVoronoiCentroids(const ofRectangle & bounds) const
+  {
+    const std::vector<glm::dvec2> centers = getVoronoiVertices();
+    
+    std::vector<glm::vec2> centroids(points.size());
+    utils::Parallel::forRange(points.size(), [&](size_t begin, size_t end) {
+      std::vector<glm::dvec2> cell, scratch;
+      for (size_t i = begin; i < end; i++)
+      {
+        getCell(i, bounds, centers, cell, scratch);
+        centroids[i] = getCentroid(cell, points[i]);
+      }
+    }, 1024);
+    return centroids;
+  }
+  
+  // Lloyd relaxation: moves every point to the centroid of its Voronoi cell and triangulates again
+  void relax(const ofRectangle & bounds, int iterations = 1)
+  {
+    for (int i = 0; i < iterations; i++)
+    {
+      points = getVoronoiCentroids(bounds);
+      triangulate();
+    }
+  }
+  
+  static std::vector<glm::vec2> relax(const std::vector<glm::vec2> & points, const ofRectangle & bounds, int iterations)
+  {
+    Delaunay delaunay(points);
+    delaunay.relax(bounds, iterations);
+    return delaunay.getPoints();
+  }
+
+protected:
+  std::vector<glm::vec2> points;
+  std::vector<double> coords; // x, y pairs, the predicates run in double precision
+  std::vector<unsigned int> triangles;
+  std::vector<unsigned int> halfedges;
+  std::vector<unsigned int> hull;
+  std::vector<unsigned int> inedges;
+  
+  // Sweep state
+  std::vector<unsigned int> hullPrev;
+  std::vector<unsigned int> hullNext;
+  std::vector<unsigned int> hullTri;
+  std::vector<unsigned int> hullHash;
+  std::vector<unsigned int> edgeStack;
+  unsigned int hullStart { 0 };
+  double cx { 0.0 }, cy { 0.0 };
+  
+  static double getDistance2(double ax, double ay, double bx, double by) { return (ax - bx) * (ax - bx) + (ay - by) * (ay - by); }
+  
+  // True when p, q, r turn clockwise
+  static bool orient(double px, double py, double qx, double qy, double rx, double ry) { return (qy - py) * (rx - qx) - (qx - px) * (ry - qy) < 0.0; }
+  
+  static bool inCircle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+  {
+    const double dx = ax - px, dy = ay - py;
+    const double ex = bx - px, ey = by - py;
+    const double fx = cx - px, fy = cy - py;
+    
+    const double ap = dx * dx + dy * dy;
+    const double bp = ex * ex + ey * ey;
+    const double cp = fx * fx + fy * fy;
+    
+    return dx * (ey * cp - bp * fy) - dy * (ex * cp - bp * fx) + ap * (ex * fy - ey * fx) < 0.0;
+  }
+  
+  static double getCircumradius2(double ax, double ay, double bx, double by, double cx, double cy)
+  {
+    const double dx = bx - ax, dy = by - ay;
+    const double ex = cx - ax, ey = cy - ay;
+    const double bl = dx * dx + dy * dy;
+    const double cl = ex * ex + ey * ey;
+    const double d = 0.5 / (dx * ey - dy * ex);
+    
+    const double x = (ey * bl - dy * cl) * d;
+    const double y = (dx * cl - ex * bl) * d;
+    return (std::isfinite(x) && std::isfinite(y)) ? x * x + y * y : std::numeric_limits<double>::max();
+  }
+  
+  static glm::dvec2 getCircumcenter(double ax, double ay, double bx, double by, double cx, double cy)
+  {
+    const double dx = bx - ax, dy = by - ay;
+    const double ex = cx - ax, ey = cy - ay;
+    const double bl = dx * dx + dy * dy;
+    const double cl = ex * ex + ey * ey;
+    const double d = 0.5 / (dx * ey - dy * ex);
+    
+    return { ax + (ey * bl - dy * cl) * d, ay + (dx * cl - ex * bl) * d };
+  }
+  
+  // Monotonic in the angle around the seed, without trigonometry
+  unsigned int getHashKey(double x, double y) const
+  {
+    const double dx = x - cx, dy = y - cy;
+    const double p = dx / (std::abs(dx) + std::abs(dy));
+    const double angle = ((dy > 0.0) ? 3.0 - p : 1.0 + p) / 4.0; // [0, 1]
+    
+    return (unsigned int) (angle * hullHash.size()) % hullHash.size();
+  }
+  
+  void link(unsigned int a, unsigned int b)
+  {
+    halfedges[a] = b;
+    if (b != EMPTY) halfedges[b] = a;
+  }
+  
+  unsigned int addTriangle(unsigned int i0, unsigned int i1, unsigned int i2, unsigned int a, unsigned int b, unsigned int c)
+  {
+    const unsigned int t = triangles.size();
+    triangles.push_back(i0);
+    triangles.push_back(i1);
+    triangles.push_back(i2);
+    halfedges.resize(t + 3, EMPTY);
+    
+    link(t, a);
+    link(t + 1, b);
+    link(t + 2, c);
+    return t;
+  }
+  
+  void triangulate()
+  {
+    const unsigned int n = points.size();
+    
+    coords.resize(n * 2);
+    for (unsigned int i = 0; i < n; i++) { coords[i * 2] = points[i].x; coords[i * 2 + 1] = points[i].y; }
+    
+    triangles.clear();
+    halfedges.clear();
+    hull.clear();
+    inedges.assign(n, EMPTY);
+    if (n < 3) return;
+    
+    const size_t maxTriangles = MAX(2 * (size_t) n - 5, (size_t) 1);
+    triangles.reserve(maxTriangles * 3);
+    halfedges.reserve(maxTriangles * 3);
+    
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for (unsigned int i = 0; i < n; i++)
+    {
+      minX = MIN(minX, coords[i * 2]); maxX = MAX(maxX, coords[i * 2]);
+      minY = MIN(minY, coords[i * 2 + 1]); maxY = MAX(maxY, coords[i * 2 + 1]);
+    }
+    
+    // Seed triangle: the point closest to the center, its closest point, and the third
+    // point making the smallest circumcircle with them
+    const double centerX = (minX + maxX) * 0.5, centerY = (minY + maxY) * 0.5;
+    unsigned int i0 = 0, i1 = EMPTY, i2 = EMPTY;
+    
+    double minDistance = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < n; i++)
+    {
+      const double distance = getDistance2(centerX, centerY, coords[i * 2], coords[i * 2 + 1]);
+      if (distance < minDistance) { i0 = i; minDistance = distance; }
+    }
+    
+    minDistance = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < n; i++)
+    {
+      if (i == i0) continue;
+      const double distance = getDistance2(coords[i0 * 2], coords[i0 * 2 + 1], coords[i * 2], coords[i * 2 + 1]);
+      if (distance < minDistance && distance > 0.0) { i1 = i; minDistance = distance; }
+    }
+    if (i1 == EMPTY) return; // all points are the same
+    
+    double minRadius = std::numeric_limits<double>::max();
+    for (unsigned int i = 0; i < n; i++)
+    {
+      if (i == i0 || i == i1) continue;
+      const double radius = getCircumradius2(coords[i0 * 2], coords[i0 * 2 + 1], coords[i1 * 2], coords[i1 * 2 + 1], coords[i * 2], coords[i * 2 + 1]);
+      if (radius < minRadius) { i2 = i; minRadius = radius; }
+    }
+    
+    std::vector<unsigned int> ids(n);
+    std::vector<double> distances(n);
+    for (unsigned int i = 0; i < n; i++) ids[i] = i;
+    
+    if (minRadius == std::numeric_limits<double>::max())
+    {
+      // Collinear: no triangles, the hull is the points in order along the line
+      for (unsigned int i = 0; i < n; i++)
+      {
+        const double dx = coords[i * 2] - coords[0];
+        distances[i] = (dx != 0.0) ? dx : coords[i * 2 + 1] - coords[1];
+      }
+      std::sort(ids.begin(), ids.end(), [&](unsigned int a, unsigned int b) { return distances[a] < distances[b]; });
+      
+      double last = std::numeric_limits<double>::lowest();
+      for (unsigned int id : ids) if (distances[id] > last) { hull.push_back(id); last = distances[id]; }
+      return;
+    }
+    
+    if (orient(coords[i0 * 2], coords[i0 * 2 + 1], coords[i1 * 2], coords[i1 * 2 + 1], coords[i2 * 2], coords[i2 * 2 + 1])) std::swap(i1, i2);
+    
+    const glm::dvec2 center = getCircumcenter(coords[i0 * 2], coords[i0 * 2 + 1], coords[i1 * 2], coords[i1 * 2 + 1], coords[i2 * 2], coords[i2 * 2 + 1]);
+    cx = center.x;
+    cy = center.y;
+    
+    // Insertion order: distance from the seed circumcenter, so every new point is outside the hull
+    for (unsigned int i = 0; i < n; i++) distances[i] = getDistance2(coords[i * 2], coords[i * 2 + 1], cx, cy);
+    std::sort(ids.begin(), ids.end(), [&](unsigned int a, unsigned int b) { return distances[a] < distances[b]; });
+    
+    // The sweep runs on the points in insertion order, so neighbouring points are close in
+    // memory, and maps back to the caller's indices at the end
+    const unsigned int seeds[3] = { i0, i1, i2 };
+    for (unsigned int k = 0; k < n; k++)
+    {
+      if (ids[k] == seeds[0]) i0 = k;
+      else if (ids[k] == seeds[1]) i1 = k;
+      else if (ids[k] == seeds[2]) i2 = k;
+      
+      coords[k * 2] = points[ids[k]].x;
+      coords[k * 2 + 1] = points[ids[k]].y;
+    }
+    
+    hullPrev.assign(n, 0);
+    hullNext.assign(n, 0);
+    hullTri.assign(n, 0);
+    hullHash.assign(MAX((unsigned int) ceil(sqrt((double) n)), 1u), EMPTY);
+    
+    hullStart = i0;
+    unsigned int hullSize = 3;
+    
+    hullNext[i0] = hullPrev[i2] = i1;
+    hullNext[i1] = hullPrev[i0] = i2;
+    hullNext[i2] = hullPrev[i1] = i0;
+    
+    hullTri[i0] = 0;
+    hullTri[i1] = 1;
+    hullTri[i2] = 2;
+    
+    hullHash[getHashKey(coords[i0 * 2], coords[i0 * 2 + 1])] = i0;
+    hullHash[getHashKey(coords[i1 * 2], coords[i1 * 2 + 1])] = i1;
+    hullHash[getHashKey(coords[i2 * 2], coords[i2 * 2 + 1])] = i2;
+    
+    addTriangle(i0, i1, i2, EMPTY, EMPTY, EMPTY);
+    
+    double xp = 0.0, yp = 0.0;
+    for (unsigned int i = 0; i < n; i++)
+    {
+      const double x = coords[i * 2], y = coords[i * 2 + 1];
+      
+      // Skip duplicates and the seed triangle
+      if (i > 0 && std::abs(x - xp) <= std::numeric_limits<double>::epsilon() && std::abs(y - yp) <= std::numeric_limits<double>::epsilon()) continue;
+      xp = x;
+      yp = y;
+      if (i == i0 || i == i1 || i == i2) continue;
+      
+      // A hull edge visible from the point, starting from the hash bucket of its angle
+      unsigned int start = 0;
+      for (unsigned int j = 0, key = getHashKey(x, y); j < hullHash.size(); j++)
+      {
+        start = hullHash[(key + j) % hullHash.size()];
+        if (start != EMPTY && start != hullNext[start]) break;
+      }
+      
+      start = hullPrev[start];
+      unsigned int e = start, q;
+      while (q = hullNext[e], !orient(x, y, coords[e * 2], coords[e * 2 + 1], coords[q * 2], coords[q * 2 + 1]))
+      {
+        e = q;
+        if (e == start) { e = EMPTY; break; }
+      }
+      if (e == EMPTY) continue; // near duplicate
+      
+      // First triangle from the point, then flip until it is Delaunay
+      unsigned int t = addTriangle(e, i, hullNext[e], EMPTY, EMPTY, hullTri[e]);
+      hullTri[i] = legalize(t + 2);
+      hullTri[e] = t;
+      hullSize++;
+      
+      // Walk forward along the hull, adding triangles
+      unsigned int next = hullNext[e];
+      while (q = hullNext[next], orient(x, y, coords[next * 2], coords[next * 2 + 1], coords[q * 2], coords[q * 2 + 1]))
+      {
+        t = addTriangle(next, i, q, hullTri[i], EMPTY, hullTri[next]);
+        hullTri[i] = legalize(t + 2);
+        hullNext[next] = next; // removed
+        hullSize--;
+        next = q;
+      }
+      
+      // And backward from the other side
+      if (e == start)
+      {
+        while (q = hullPrev[e], orient(x, y, coords[q * 2], coords[q * 2 + 1], coords[e * 2], coords[e * 2 + 1]))
+        {
+          t = addTriangle(q, i, e, EMPTY, hullTri[e], hullTri[q]);
+          legalize(t + 2);
+          hullTri[q] = t;
+          hullNext[e] = e; // removed
+          hullSize--;
+          e = q;
+        }
+      }
+      
+      hullStart = hullPrev[i] = e;
+      hullNext[e] = hullPrev[next] = i;
+      hullNext[i] = next;
+      
+      hullHash[getHashKey(x, y)] = i;
+      hullHash[getHashKey(coords[e * 2], coords[e * 2 + 1])] = e;
+    }
+    
+    hull.resize(hullSize);
+    for (unsigned int i = 0, e = hullStart; i < hullSize; i++, e = hullNext[e]) hull[i] = ids[e];
+    
+    for (auto & index : triangles) index = ids[index];
+    for (unsigned int i = 0; i < n; i++) { coords[i * 2] = points[i].x; coords[i * 2 + 1] = points[i].y; }
+    
+    // Hull points keep their hull half-edge so walks around them start on the hull
+    for (unsigned int e = 0; e < triangles.size(); e++)
+    {
+      const unsigned int p = triangles[nextHalfedge(e)];
+      if (halfedges[e] == EMPTY || inedges[p] == EMPTY) inedges[p] = e;
+    }
+  }
+  
+  // Flips edges around `a` until the triangles around it are Delaunay
+  unsigned int legalize(unsigned int a)
+  {
+    edgeStack.clear();
+    unsigned int ar = 0;
+    
+    while (true)
+    {
+      const unsigned int b = halfedges[a];
+      const unsigned int a0 = a - a % 3;
+      ar = a0 + (a + 2) % 3;
+      
+      if (b == EMPTY)
+      {
+        if (edgeStack.empty()) break;
+        a = edgeStack.back();
+        edgeStack.pop_back();
+        continue;
+      }
+      
+      const unsigned int b0 = b - b % 3;
+      const unsigned int al = a0 + (a + 1) % 3;
+      const unsigned int bl = b0 + (b + 2) % 3;
+      
+      const unsigned int p0 = triangles[ar];
+      const unsigned int pr = triangles[a];
+      const unsigned int pl = triangles[al];
+      const unsigned int p1 = triangles[bl];
+      
+      const bool illegal = inCircle(coords[p0 * 2], coords[p0 * 2 + 1], coords[pr * 2], coords[pr * 2 + 1], coords[pl * 2], coords[pl * 2 + 1], coords[p1 * 2], coords[p1 * 2 + 1]);
+      
+      if (illegal)
+      {
+        triangles[a] = p1;
+        triangles[b] = p0;
+        
+        // The flipped edge was on the hull on the other side (rare), fix the reference
+        const unsigned int hbl = halfedges[bl];
+        if (hbl == EMPTY)
+        {
+          unsigned int e = hullStart;
+          do {
+            if (hullTri[e] == bl) { hullTri[e] = a; break; }
+            e = hullPrev[e];
+          } while (e != hullStart);
+        }
+        
+        link(a, hbl);
+        link(b, halfedges[ar]);
+        link(ar, bl);
+        
+        edgeStack.push_back(b0 + (b + 1) % 3);
+      }
+      else
+      {
+        if (edgeStack.empty()) break;
+        a = edgeStack.back();
+        edgeStack.pop_back();
+      }
+    }
+    
+    return ar;
+  }
+  
+  std::vector<glm::dvec2> getVoronoiVertices() const
+  {
+    std::vector<glm::dvec2> centers(getNumTriangles());
+    utils::Parallel::forRange(centers.size(), [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; t++)
+      {
+        const unsigned int * v = &triangles[t * 3];
+        centers[t] = getCircumcenter(coords[v[0] * 2], coords[v[0] * 2 + 1], coords[v[1] * 2], coords[v[1] * 2 + 1], coords[v[2] * 2], coords[v[2] * 2 + 1]);
+      }
+    }, 1024);
+    return centers;
+  }
+  
+  // The cell of an inner point is the loop of circumcenters around it; only when one of them
+  // falls outside `bounds`, or the point is on the hull, does the cell need clipping
+  void getCell(unsigned int i, const ofRectangle & bounds, const std::vector<glm::dvec2> & centers, std::vector<glm::dvec2> & cell, std::vector<glm::dvec2> & scratch) const
+  {
+    cell.clear();
+    
+    const unsigned int start = inedges[i];
+    if (start != EMPTY && halfedges[start] != EMPTY)
+    {
+      bool inside = true;
+      unsigned int e = start;
+      do {
+        const glm::dvec2 & center = centers[e / 3];
+        if (center.x < bounds.getLeft() || center.x > bounds.getRight() || center.y < bounds.getTop() || center.y > bounds.getBottom()) { inside = false; break; }
+        
+        cell.push_back(center);
+        e = halfedges[nextHalfedge(e)];
+      } while (e != start);
+      
+      if (inside) return;
+    }
+    
+    clipCell(i, bounds, cell, scratch);
+  }
+  
+  // `bounds` cut by the half planes closer to point `i` than to each of its neighbours
+  void clipCell(unsigned int i, const ofRectangle & bounds, std::vector<glm::dvec2> & cell, std::vector<glm::dvec2> & scratch) const
+  {
+    cell.clear();
+    
+    // Collinear points have no triangles, their neighbours are along the hull
+    size_t onHull = hull.size();
+    if (triangles.empty()) onHull = std::find(hull.begin(), hull.end(), i) - hull.begin();
+    
+    if ((triangles.empty()) ? onHull == hull.size() : inedges[i] == EMPTY) return;
+    
+    cell.push_back({ bounds.getLeft(), bounds.getTop() });
+    cell.push_back({ bounds.getRight(), bounds.getTop() });
+    cell.push_back({ bounds.getRight(), bounds.getBottom() });
+    cell.push_back({ bounds.getLeft(), bounds.getBottom() });
+    
+    const glm::dvec2 p { coords[i * 2], coords[i * 2 + 1] };
+    auto clip = [&](const glm::dvec2 & q) {
+      // Keep the side of the bisector of p and q that holds p
+      const glm::dvec2 normal = q - p;
+      const double offset = glm::dot(normal, (p + q) * 0.5);
+      
+      scratch.clear();
+      for (size_t k = 0; k < cell.size(); k++)
+      {
+        const glm::dvec2 & a = cell[k];
+        const glm::dvec2 & b = cell[(k + 1) % cell.size()];
+        const double da = glm::dot(normal, a) - offset;
+        const double db = glm::dot(normal, b) - offset;
+        
+        if (da <= 0.0) scratch.push_back(a);
+        if ((da < 0.0 && db > 0.0) || (da > 0.0 && db < 0.0)) scratch.push_back(a + (b - a) * (da / (da - db)));
+      }
+      std::swap(cell, scratch);
+    };
+    
+    if (!triangles.empty()) forEachNeighbour(i, [&](unsigned int j, unsigned int) { if (!cell.empty()) clip({ coords[j * 2], coords[j * 2 + 1] }); });
+    else
+    {
+      if (onHull > 0) clip({ coords[hull[onHull - 1] * 2], coords[hull[onHull - 1] * 2 + 1] });
+      if (onHull + 1 < hull.size()) clip({ coords[hull[onHull + 1] * 2], coords[hull[onHull + 1] * 2 + 1] });
+    }
+  }
+  
+  static glm::vec2 getCentroid(const std::vector<glm::dvec2> & cell, const glm::vec2 & fallback)
+  {
+    double area = 0.0;
+    glm::dvec2 centroid { 0.0, 0.0 };
+    
+    for (size_t k = 0; k < cell.size(); k++)
+    {
+      const glm::dvec2 & a = cell[k];
+      const glm::dvec2 & b = cell[(k + 1) % cell.size()];
+      const double cross = a.x * b.y - b.x * a.y;
+      area += cross;
+      centroid += (a + b) * cross;
+    }
+    
+    if (std::abs(area) < 1e-12) return fallback;
+    return glm::vec2(centroid / (3.0 * area));
+  }
+};
+
+}}}
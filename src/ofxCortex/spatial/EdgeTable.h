@@ -0,0 +1,346 @@
+#pragma once
+
+#include "ofPolyline.h"
+#include "ofRectangle.h"
+
+namespace ofxCortex { namespace core { namespace spatial {
+
+// Edges of one or more closed polygons bucketed into horizontal bands, so a
+// containment test only looks at the edges crossing the band of the point.
+// Multiple polygons are combined with the even-odd rule (holes punch out).
+class ScanlineEdgeTable {
+public:
+  struct Edge {
+    glm::vec2 a;
+    glm::vec2 b;
+    float dxdy;
+  };
+  
+  ScanlineEdgeTable() = default;
+  ScanlineEdgeTable(const ofPolyline & polygon, int numBands = 0) { setup(std::vector<ofPolyline>{ polygon }, numBands); }
+  ScanlineEdgeTable(const std::vector<ofPolyline> & polygons, int numBands = 0) { setup(polygons, numBands); }
+  
+  void setup(const std::vector<ofPolyline> & polygons, int numBands = 0)
+  {
+    edges.clear();
+    
+    for (const auto & polygon : polygons)
+    {
+      const auto & vertices = polygon.getVertices();
+      for (size_t i = 0, len = vertices.size(), j = len - 1; i < len; j = i++)
+      {
+        glm::vec2 a = vertices[j];
+        glm::vec2 b = vertices[i];
+        
+        if (a.y == b.y) continue;
+        
+        edges.push_back({ a, b, (b.x - a.x) / (b.y - a.y) });
+      }
+    }
+    
+    glm::vec2 min { std::numeric_limits<float>::max() };
+    glm::vec2 max { std::numeric_limits<float>::lowest() };
+    for (const Edge & edge : edges)
+    {
+      min = glm::min(min, glm::min(edge.a, edge.b));
+      max = glm::max(max, glm::max(edge.a, edge.b));
+    }
+    bounds = (edges.empty()) ? ofRectangle() : ofRectangle(min.x, min.y, max.x - min.x, max.y - min.y);
+    
+    if (numBands <= 0) numBands = CLAMP((int) edges.size() / 2, 1, 1024);
+    bandCount = numBands;
+    bandHeight = MAX(bounds.height / bandCount, std::numeric_limits<float>::epsilon());
+    
+    // Count, prefix-sum, then fill: a flat bucket layout with no per-band allocations
+    bandOffsets.assign(bandCount + 1, 0);
+    for (const Edge & edge : edges)
+    {
+      auto range = getBandRange(edge);
+      for (int band = range.first; band <= range.second; band++) bandOffsets[band + 1]++;
+    }
+    for (int band = 0; band < bandCount; band++) bandOffsets[band + 1] += bandOffsets[band];
+    
+    bandEdges.resize(bandOffsets.back());
+    std::vector<unsigned int> cursor(bandOffsets.begin(), bandOffsets.end() - 1);
+    for (unsigned int i = 0; i < edges.size(); i++)
+    {
+      auto range = getBandRange(edges[i]);
+      for (int band = range.first; band <= range.second; band++) bandEdges[cursor[band]++] = i;
+    }
+  }
+  
+  bool inside(float x, float y) const
+  {
+    if (edges.empty() || y < bounds.getTop() || y > bounds.getBottom() || x < bounds.getLeft() || x > bounds.getRight()) return false;
+    
+    const int band = CLAMP((int)((y - bounds.y) / bandHeight), 0, bandCount - 1);
+    
+    bool isInside = false;
+    for (unsigned int i = bandOffsets[band]; i < bandOffsets[band + 1]; i++)
+    {
+      const Edge & edge = edges[bandEdges[i]];
+      if ((edge.a.y > y) != (edge.b.y > y) && x < edge.a.x + (y - edge.a.y) * edge.dxdy) isInside = !isInside;
+    }
+    
+    return isInside;
+  }
+  
+  bool inside(const glm::vec2 & p) const { return inside(p.x, p.y); }
+  
+  const ofRectangle & getBoundingBox() const { return bounds; }
+  const std::vector<Edge> & getEdges() const { return edges; }
+  bool empty() const { return edges.empty(); }
+
+protected:
+  std::vector<Edge> edges;
+  std::vector<unsigned int> bandOffsets;
+  std::vector<unsigned int> bandEdges;
+  
+  ofRectangle bounds;
+  int bandCount { 1 };
+  float bandHeight { 1.0f };
+  
+  std::pair<int, int> getBandRange(const Edge & edge) const
+  {
+    int first = (int)((MIN(edge.a.y, edge.b.y) - bounds.y) / bandHeight);
+    int last = (int)((MAX(edge.a.y, edge.b.y) - bounds.y) / bandHeight);
+    
+    return { CLAMP(first, 0, bandCount - 1), CLAMP(last, 0, bandCount - 1) };
+  }
+};
+
+// Edge table sorted by y plus an active-edge list, for sweeping evenly spaced
+// horizontal scanlines over closed polygons. Each row only touches the edges
+// that cross it, and the crossings stay sorted by x with an insertion sort that
+// is linear on the nearly sorted rows. Polygons can be rotated on setup to sweep
+// in any direction; rows then run along (cos(angle), sin(angle)).
+class ScanlineSweep {
+public:
+  struct Crossing {
+    float x;
+    int winding; // +1 where the edge runs towards +y, -1 otherwise
+    unsigned int edge;
+  };
+  
+  ScanlineSweep() = default;
+  ScanlineSweep(const std::vector<ofPolyline> & polygons, float angle = 0.0f) { setup(polygons, angle); }
+  
+  void setup(const std::vector<ofPolyline> & polygons, float angle = 0.0f)
+  {
+    cosAngle = cos(angle);
+    sinAngle = sin(angle);
+    
+    edges.clear();
+    minY = std::numeric_limits<float>::max();
+    maxY = std::numeric_limits<float>::lowest();
+    
+    for (const auto & polygon : polygons)
+    {
+      const auto & vertices = polygon.getVertices();
+      for (size_t i = 0, len = vertices.size(), j = len - 1; i < len; j = i++)
+      {
+        const glm::vec2 a = toSweep(vertices[j]);
+        const glm::vec2 b = toSweep(vertices[i]);
+        if (a.y == b.y) continue;
+        
+        const glm::vec2 & top = (a.y < b.y) ? a : b;
+        const glm::vec2 & bottom = (a.y < b.y) ? b : a;
+        edges.push_back({ top.y, bottom.y, top.x, (bottom.x - top.x) / (bottom.y - top.y), (a.y < b.y) ? 1 : -1 });
+        
+        minY = MIN(minY, top.y);
+        maxY = MAX(maxY, bottom.y);
+      }
+    }
+    
+    std::sort(edges.begin(), edges.end(), [](const Edge & a, const Edge & b) { return a.yMin < b.yMin; });
+  }
+  
+  // Calls onRow(row, y, crossings) for every y = start + row * spacing inside the polygons' span.
+  // Edges cover [yMin, yMax), so a scanline through a vertex counts the vertex once.
+  template<typename Func>
+  void sweep(float start, float spacing, Func && onRow) const
+  {
+    if (edges.empty() || spacing <= 0.0f) return;
+    
+    std::vector<Crossing> active;
+    size_t next = 0;
+    
+    for (int row = MAX((int) ceil((minY - start) / spacing), 0); ; row++)
+    {
+      const float y = start + row * spacing;
+      if (y >= maxY) break;
+      
+      while (next < edges.size() && edges[next].yMin <= y) { active.push_back({ 0.0f, edges[next].winding, (unsigned int) next }); next++; }
+      active.erase(std::remove_if(active.begin(), active.end(), [&](const Crossing & crossing) { return edges[crossing.edge].yMax <= y; }), active.end());
+      
+      for (Crossing & crossing : active)
+      {
+        const Edge & edge = edges[crossing.edge];
+        crossing.x = edge.x + (y - edge.yMin) * edge.dxdy;
+      }
+      
+      // Order barely changes between rows, so this is close to a single pass
+      for (size_t i = 1; i < active.size(); i++)
+      {
+        const Crossing crossing = active[i];
+        size_t j = i;
+        for (; j > 0 && active[j - 1].x > crossing.x; j--) active[j] = active[j - 1];
+        active[j] = crossing;
+      }
+      
+      onRow(row, y, (const std::vector<Crossing> &) active);
+    }
+  }
+  
+  float getMinY() const { return minY; }
+  float getMaxY() const { return maxY; }
+  bool empty() const { return edges.empty(); }
+  
+  glm::vec2 toSweep(const glm::vec2 & p) const { return { cosAngle * p.x + sinAngle * p.y, -sinAngle * p.x + cosAngle * p.y }; }
+  glm::vec2 fromSweep(float x, float y) const { return { cosAngle * x - sinAngle * y, sinAngle * x + cosAngle * y }; }
+
+protected:
+  struct Edge {
+    float yMin;
+    float yMax;
+    float x; // at yMin
+    float dxdy;
+    int winding;
+  };
+  
+  std::vector<Edge> edges; // sorted by yMin
+  float minY { 0.0f };
+  float maxY { 0.0f };
+  float cosAngle { 1.0f };
+  float sinAngle { 0.0f };
+};
+
+// Edges of one or more closed polygons bucketed into a uniform grid, so a
+// distance query only looks at the cells around the point, ring by ring, until
+// no closer edge can be left. Pair with ScanlineEdgeTable for the sign.
+class EdgeGrid {
+public:
+  struct Edge {
+    glm::vec2 a;
+    glm::vec2 ab;
+    float invLength2;
+  };
+  
+  EdgeGrid() = default;
+  EdgeGrid(const ofPolyline & polygon, float edgesPerCell = 2.0f) { setup(std::vector<ofPolyline>{ polygon }, edgesPerCell); }
+  EdgeGrid(const std::vector<ofPolyline> & polygons, float edgesPerCell = 2.0f) { setup(polygons, edgesPerCell); }
+  
+  void setup(const std::vector<ofPolyline> & polygons, float edgesPerCell = 2.0f)
+  {
+    edges.clear();
+    
+    glm::vec2 min { std::numeric_limits<float>::max() };
+    glm::vec2 max { std::numeric_limits<float>::lowest() };
+    
+    for (const auto & polygon : polygons)
+    {
+      const auto & vertices = polygon.getVertices();
+      for (size_t i = 0, len = vertices.size(), j = len - 1; i < len; j = i++)
+      {
+        const glm::vec2 a = vertices[j];
+        const glm::vec2 ab = glm::vec2(vertices[i]) - a;
+        const float length2 = glm::dot(ab, ab);
+        
+        edges.push_back({ a, ab, (length2 > 0.0f) ? 1.0f / length2 : 0.0f });
+        min = glm::min(min, glm::min(a, a + ab));
+        max = glm::max(max, glm::max(a, a + ab));
+      }
+    }
+    
+    if (edges.empty()) return;
+    
+    // Square cells, about `edgesPerCell` edges each on an evenly spread outline
+    const glm::vec2 size = glm::max(max - min, glm::vec2(std::numeric_limits<float>::epsilon()));
+    const float numCells = MAX(edges.size() / MAX(edgesPerCell, 0.1f), 1.0f);
+    cellSize = MAX(sqrt(size.x * size.y / numCells), MAX(size.x, size.y) / 1024.0f);
+    columns = CLAMP((int) (size.x / cellSize) + 1, 1, 1024);
+    rows = CLAMP((int) (size.y / cellSize) + 1, 1, 1024);
+    origin = min;
+    
+    // Count, prefix-sum, then fill, like ScanlineEdgeTable; edges go in every cell their bounds touch
+    cellOffsets.assign(columns * rows + 1, 0);
+    forEachCell([&](unsigned int, int cell) { cellOffsets[cell + 1]++; });
+    for (size_t i = 1; i < cellOffsets.size(); i++) cellOffsets[i] += cellOffsets[i - 1];
+    
+    cellEdges.resize(cellOffsets.back());
+    std::vector<unsigned int> cursor(cellOffsets.begin(), cellOffsets.end() - 1);
+    forEachCell([&](unsigned int edge, int cell) { cellEdges[cursor[cell]++] = edge; });
+  }
+  
+  // Unsigned distance to the closest edge
+  float getDistance(const glm::vec2 & p) const
+  {
+    if (edges.empty()) return std::numeric_limits<float>::max();
+    
+    const int cx = CLAMP((int) floor((p.x - origin.x) / cellSize), 0, columns - 1);
+    const int cy = CLAMP((int) floor((p.y - origin.y) / cellSize), 0, rows - 1);
+    
+    float best = std::numeric_limits<float>::max();
+    
+    auto visit = [&](int x, int y) {
+      if (x < 0 || y < 0 || x >= columns || y >= rows) return;
+      
+      const int cell = y * columns + x;
+      for (unsigned int i = cellOffsets[cell]; i < cellOffsets[cell + 1]; i++) best = MIN(best, getDistance2(edges[cellEdges[i]], p));
+    };
+    
+    // Cells past ring r are at least r cells away from p
+    for (int r = 0, maxRing = MAX(columns, rows); r <= maxRing; r++)
+    {
+      for (int y = cy - r; y <= cy + r; y++)
+      {
+        if (y == cy - r || y == cy + r) { for (int x = cx - r; x <= cx + r; x++) visit(x, y); }
+        else { visit(cx - r, y); visit(cx + r, y); }
+      }
+      
+      if (best <= (r * cellSize) * (r * cellSize)) break;
+    }
+    
+    return sqrt(best);
+  }
+  
+  const std::vector<Edge> & getEdges() const { return edges; }
+  bool empty() const { return edges.empty(); }
+  
+  // Squared distance from p to the closest point of `edge`
+  static float getDistance2(const Edge & edge, const glm::vec2 & p)
+  {
+    const float t = CLAMP(glm::dot(p - edge.a, edge.ab) * edge.invLength2, 0.0f, 1.0f);
+    const glm::vec2 d = edge.a + edge.ab * t - p;
+    return glm::dot(d, d);
+  }
+
+protected:
+  std::vector<Edge> edges;
+  std::vector<unsigned int> cellOffsets;
+  std::vector<unsigned int> cellEdges;
+  
+  glm::vec2 origin;
+  float cellSize { 1.0f };
+  int columns { 1 };
+  int rows { 1 };
+  
+  template<typename Func>
+  void forEachCell(Func && func) const
+  {
+    for (unsigned int i = 0; i < edges.size(); i++)
+    {
+      const glm::vec2 a = edges[i].a;
+      const glm::vec2 b = a + edges[i].ab;
+      
+      const int x0 = CLAMP((int) ((MIN(a.x, b.x) - origin.x) / cellSize), 0, columns - 1);
+      const int x1 = CLAMP((int) ((MAX(a.x, b.x) - origin.x) / cellSize), 0, columns - 1);
+      const int y0 = CLAMP((int) ((MIN(a.y, b.y) - origin.y) / cellSize), 0, rows - 1);
+      const int y1 = CLAMP((int) ((MAX(a.y, b.y) - origin.y) / cellSize), 0, rows - 1);
+      
+      for (int y = y0; y <= y1; y++) for (int x = x0; x <= x1; x++) func(i, y * columns + x);
+    }
+  }
+};
+
+}}}
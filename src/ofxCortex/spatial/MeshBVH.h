@@ -0,0 +1,240 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofLog.h"
+
+namespace ofxCortex { namespace core { namespace spatial {
+
+// Bounding volume hierarchy over the triangles of an ofMesh. Built once, then
+// answers ray and inside/outside queries in roughly O(log triangles).
+class MeshBVH {
+public:
+  struct Triangle {
+    glm::vec3 v0;
+    glm::vec3 e1;
+    glm::vec3 e2;
+  };
+  
+  struct Node {
+    glm::vec3 min;
+    glm::vec3 max;
+    unsigned int start; // first triangle (leaf) or right child (inner)
+    unsigned int count; // 0 for inner nodes
+  };
+  
+  MeshBVH() = default;
+  MeshBVH(const ofMesh & mesh, int maxLeafSize = 4) { setup(mesh, maxLeafSize); }
+  
+  void setup(const ofMesh & mesh, int maxLeafSize = 4)
+  {
+    triangles.clear();
+    nodes.clear();
+    
+    if (mesh.getMode() != OF_PRIMITIVE_TRIANGLES)
+    {
+      ofLogWarning("MeshBVH::setup") << "ofMesh mode should be OF_PRIMITIVE_TRIANGLES";
+      return;
+    }
+    
+    const auto & vertices = mesh.getVertices();
+    const auto & indices = mesh.getIndices();
+    const size_t numCorners = (mesh.hasIndices()) ? indices.size() : vertices.size();
+    
+    triangles.reserve(numCorners / 3);
+    for (size_t i = 0; i + 2 < numCorners; i += 3)
+    {
+      const glm::vec3 & a = vertices[(mesh.hasIndices()) ? indices[i + 0] : i + 0];
+      const glm::vec3 & b = vertices[(mesh.hasIndices()) ? indices[i + 1] : i + 1];
+      const glm::vec3 & c = vertices[(mesh.hasIndices()) ? indices[i + 2] : i + 2];
+      
+      triangles.push_back({ a, b - a, c - a });
+    }
+    
+    if (triangles.empty()) return;
+    
+    std::vector<glm::vec3> centroids(triangles.size());
+    for (size_t i = 0; i < triangles.size(); i++) centroids[i] = triangles[i].v0 + (triangles[i].e1 + triangles[i].e2) / 3.0f;
+    
+    std::vector<unsigned int> order(triangles.size());
+    std::iota(order.begin(), order.end(), 0);
+    
+    nodes.reserve(triangles.size() * 2 / MAX(maxLeafSize, 1) + 1);
+    build(order, centroids, 0, order.size(), MAX(maxLeafSize, 1));
+    
+    std::vector<Triangle> sorted(triangles.size());
+    for (size_t i = 0; i < order.size(); i++) sorted[i] = triangles[order[i]];
+    triangles.swap(sorted);
+  }
+  
+  // Returns the distance to the closest hit along `direction`, or a negative value on a miss.
+  float raycast(const glm::vec3 & origin, const glm::vec3 & direction) const
+  {
+    float closest = std::numeric_limits<float>::max();
+    
+    traverse(origin, direction, [&](const Triangle & triangle) {
+      float t;
+      if (intersect(triangle, origin, direction, t) && t < closest) closest = t;
+    }, closest);
+    
+    return (closest == std::numeric_limits<float>::max()) ? -1.0f : closest;
+  }
+  
+  // Number of triangles crossed by the ray starting at `origin`.
+  size_t countHits(const glm::vec3 & origin, const glm::vec3 & direction) const
+  {
+    size_t hits = 0;
+    
+    traverse(origin, direction, [&](const Triangle & triangle) {
+      float t;
+      if (intersect(triangle, origin, direction, t)) hits++;
+    }, std::numeric_limits<float>::max());
+    
+    return hits;
+  }
+  
+  // Parity test along a skewed axis; assumes a closed (watertight) mesh.
+  bool inside(const glm::vec3 & p) const
+  {
+    if (nodes.empty() || !overlapsBox(nodes[0], p)) return false;
+    
+    static const glm::vec3 direction = glm::normalize(glm::vec3(1.0f, 0.0137f, 0.0071f));
+    return countHits(p, direction) % 2 == 1;
+  }
+  
+  glm::vec3 getMin() const { return (nodes.empty()) ? glm::vec3(0) : nodes[0].min; }
+  glm::vec3 getMax() const { return (nodes.empty()) ? glm::vec3(0) : nodes[0].max; }
+  
+  size_t getNumTriangles() const { return triangles.size(); }
+  size_t getNumNodes() const { return nodes.size(); }
+  bool empty() const { return triangles.empty(); }
+
+protected:
+  std::vector<Triangle> triangles;
+  std::vector<Node> nodes;
+  
+  unsigned int build(std::vector<unsigned int> & order, const std::vector<glm::vec3> & centroids, size_t start, size_t end, int maxLeafSize)
+  {
+    const unsigned int nodeIndex = nodes.size();
+    nodes.push_back(Node());
+    
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    glm::vec3 max { std::numeric_limits<float>::lowest() };
+    glm::vec3 centroidMin = min;
+    glm::vec3 centroidMax = max;
+    
+    for (size_t i = start; i < end; i++)
+    {
+      const Triangle & triangle = triangles[order[i]];
+      const glm::vec3 b = triangle.v0 + triangle.e1;
+      const glm::vec3 c = triangle.v0 + triangle.e2;
+      
+      min = glm::min(min, glm::min(triangle.v0, glm::min(b, c)));
+      max = glm::max(max, glm::max(triangle.v0, glm::max(b, c)));
+      centroidMin = glm::min(centroidMin, centroids[order[i]]);
+      centroidMax = glm::max(centroidMax, centroids[order[i]]);
+    }
+    
+    nodes[nodeIndex].min = min;
+    nodes[nodeIndex].max = max;
+    
+    const glm::vec3 extent = centroidMax - centroidMin;
+    const int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z) ? 1 : 2;
+    
+    if (end - start <= (size_t) maxLeafSize || extent[axis] <= 0.0f)
+    {
+      nodes[nodeIndex].start = start;
+      nodes[nodeIndex].count = end - start;
+      return nodeIndex;
+    }
+    
+    const size_t mid = start + (end - start) / 2;
+    std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](unsigned int a, unsigned int b) { return centroids[a][axis] < centroids[b][axis]; });
+    
+    build(order, centroids, start, mid, maxLeafSize);
+    const unsigned int right = build(order, centroids, mid, end, maxLeafSize);
+    
+    nodes[nodeIndex].start = right;
+    nodes[nodeIndex].count = 0;
+    
+    return nodeIndex;
+  }
+  
+  template<typename Func>
+  void traverse(const glm::vec3 & origin, const glm::vec3 & direction, Func && visit, const float & maxDistance) const
+  {
+    if (nodes.empty()) return;
+    
+    const glm::vec3 inverse = 1.0f / direction;
+    
+    unsigned int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0)
+    {
+      const Node & node = nodes[stack[--stackSize]];
+      
+      if (!intersectsBox(node, origin, inverse, maxDistance)) continue;
+      
+      if (node.count > 0)
+      {
+        for (unsigned int i = node.start; i < node.start + node.count; i++) visit(triangles[i]);
+      }
+      else if (stackSize < 63)
+      {
+        const unsigned int self = &node - nodes.data();
+        stack[stackSize++] = node.start;
+        stack[stackSize++] = self + 1;
+      }
+    }
+  }
+  
+  static bool overlapsBox(const Node & node, const glm::vec3 & p)
+  {
+    return p.x >= node.min.x && p.y >= node.min.y && p.z >= node.min.z && p.x <= node.max.x && p.y <= node.max.y && p.z <= node.max.z;
+  }
+  
+  static bool intersectsBox(const Node & node, const glm::vec3 & origin, const glm::vec3 & inverse, float maxDistance)
+  {
+    float tmin = 0.0f;
+    float tmax = maxDistance;
+    
+    for (int axis = 0; axis < 3; axis++)
+    {
+      float t0 = (node.min[axis] - origin[axis]) * inverse[axis];
+      float t1 = (node.max[axis] - origin[axis]) * inverse[axis];
+      if (t0 > t1) std::swap(t0, t1);
+      
+      tmin = MAX(tmin, t0);
+      tmax = MIN(tmax, t1);
+      if (tmax < tmin) return false;
+    }
+    
+    return true;
+  }
+  
+  // Moller-Trumbore, same tolerances as utils::rayTriangleIntersection
+  static bool intersect(const Triangle & triangle, const glm::vec3 & origin, const glm::vec3 & direction, float & t)
+  {
+    static const float EPSILON = 0.00000001;
+    
+    const glm::vec3 P = glm::cross(direction, triangle.e2);
+    const float det = glm::dot(triangle.e1, P);
+    if (det > -EPSILON && det < EPSILON) return false;
+    
+    const float invDet = 1.0f / det;
+    const glm::vec3 T = origin - triangle.v0;
+    
+    const float u = glm::dot(T, P) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    
+    const glm::vec3 Q = glm::cross(T, triangle.e1);
+    const float v = glm::dot(direction, Q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    
+    t = glm::dot(triangle.e2, Q) * invDet;
+    return t > EPSILON;
+  }
+};
+
+}}}
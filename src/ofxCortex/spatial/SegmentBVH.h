@@ -0,0 +1,473 @@
+#pragma once
+
+#include "ofPolyline.h"
+
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace spatial {
+
+// Bounding volume hierarchy over the segments of a set of polylines (in 2D,
+// z is ignored). Answers closest point, signed distance, ray / segment
+// intersections and radius queries in roughly O(log segments) each.
+// Segment `s` of a line runs from vertex s to s + 1, closed lines add a last
+// segment back to vertex 0.
+class SegmentBVH {
+public:
+  struct Segment {
+    glm::vec2 a;
+    glm::vec2 b;
+    unsigned int line;
+    unsigned int index;
+    bool closed; // part of a closed line, used for the inside / outside parity
+    bool last; // last segment of an open line, owns its end point
+  };
+  
+  struct Node {
+    glm::vec2 min;
+    glm::vec2 max;
+    unsigned int start; // first segment (leaf) or right child (inner)
+    unsigned int count; // 0 for inner nodes
+  };
+  
+  // A point on a segment: `t` is the parameter along the segment, 0 at a and 1 at b
+  struct Nearest {
+    glm::vec2 point;
+    float distance { -1.0f }; // negative when nothing was found
+    unsigned int line { 0 };
+    unsigned int segment { 0 };
+    float t { 0.0f };
+    
+    bool found() const { return distance >= 0.0f; }
+  };
+  
+  // A crossing of a ray or query segment: `distance` is along the query (in units of
+  // its direction), `t` along the crossed segment
+  struct Hit {
+    glm::vec2 point;
+    float distance { -1.0f };
+    unsigned int line { 0 };
+    unsigned int segment { 0 };
+    float t { 0.0f };
+    
+    bool found() const { return distance >= 0.0f; }
+  };
+  
+  SegmentBVH() = default;
+  SegmentBVH(const ofPolyline & line, int maxLeafSize = 4) { setup(std::vector<ofPolyline>{ line }, maxLeafSize); }
+  SegmentBVH(const std::vector<ofPolyline> & lines, int maxLeafSize = 4) { setup(lines, maxLeafSize); }
+  
+  void setup(const std::vector<ofPolyline> & lines, int maxLeafSize = 4)
+  {
+    segments.clear();
+    nodes.clear();
+    hasClosed = false;
+    
+    for (unsigned int i = 0; i < lines.size(); i++)
+    {
+      const auto & vertices = lines[i].getVertices();
+      const bool closed = lines[i].isClosed() && vertices.size() > 2;
+      const size_t numSegments = (closed) ? vertices.size() : (vertices.size() > 1) ? vertices.size() - 1 : 0;
+      
+      for (size_t s = 0; s < numSegments; s++)
+      {
+        const glm::vec2 a = vertices[s];
+        const glm::vec2 b = vertices[(s + 1) % vertices.size()];
+        segments.push_back({ a, b, i, (unsigned int) s, closed, !closed && s + 1 == numSegments });
+      }
+      
+      hasClosed |= closed;
+    }
+    
+    if (segments.empty()) return;
+    
+    std::vector<glm::vec2> centroids(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) centroids[i] = (segments[i].a + segments[i].b) * 0.5f;
+    
+    std::vector<unsigned int> order(segments.size());
+    std::iota(order.begin(), order.end(), 0);
+    
+    nodes.reserve(segments.size() * 2 / MAX(maxLeafSize, 1) + 1);
+    build(order, centroids, 0, order.size(), MAX(maxLeafSize, 1));
+    
+    std::vector<Segment> sorted(segments.size());
+    for (size_t i = 0; i < order.size(); i++) sorted[i] = segments[order[i]];
+    segments.swap(sorted);
+  }
+
+#pragma mark - Distance
+
+  // Closest point on any segment, ignoring segments further than `maxDistance`
+  Nearest getClosest(const glm::vec2 & p, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    Nearest nearest;
+    if (nodes.empty()) return nearest;
+    
+    float best = (maxDistance < std::numeric_limits<float>::max()) ? maxDistance * maxDistance : maxDistance;
+    const Segment * closest = nullptr;
+    float closestT = 0.0f;
+    
+    unsigned int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0)
+    {
+      const unsigned int index = stack[--stackSize];
+      const Node & node = nodes[index];
+      
+      if (getBoxDistance2(node, p) > best) continue;
+      
+      if (node.count > 0)
+      {
+        for (unsigned int i = node.start; i < node.start + node.count; i++)
+        {
+          float t;
+          const float distance = getSegmentDistance2(segments[i], p, t);
+          if (distance <= best) { best = distance; closest = &segments[i]; closestT = t; }
+        }
+      }
+      else if (stackSize < 62)
+      {
+        // Nearer child on top of the stack, so it shrinks `best` before the other one is tested
+        const unsigned int left = index + 1;
+        const unsigned int right = node.start;
+        const bool leftFirst = getBoxDistance2(nodes[left], p) <= getBoxDistance2(nodes[right], p);
+        
+        stack[stackSize++] = (leftFirst) ? right : left;
+        stack[stackSize++] = (leftFirst) ? left : right;
+      }
+    }
+    
+    if (closest)
+    {
+      nearest.point = glm::mix(closest->a, closest->b, closestT);
+      nearest.distance = sqrt(best);
+      nearest.line = closest->line;
+      nearest.segment = closest->index;
+      nearest.t = closestT;
+    }
+    
+    return nearest;
+  }
+  
+  float getDistance(const glm::vec2 & p) const
+  {
+    const Nearest nearest = getClosest(p);
+    return (nearest.found()) ? nearest.distance : std::numeric_limits<float>::max();
+  }
+  
+  // Negative inside the closed lines (even-odd, so nested lines punch holes), positive outside.
+  // Open lines only contribute to the distance.
+  float getSignedDistance(const glm::vec2 & p) const
+  {
+    const float distance = getDistance(p);
+    return (inside(p)) ? -distance : distance;
+  }
+  
+  // Even-odd parity of the closed lines along a ray towards +x
+  bool inside(const glm::vec2 & p) const
+  {
+    if (!hasClosed || nodes.empty()) return false;
+    
+    bool result = false;
+    
+    unsigned int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0)
+    {
+      const unsigned int index = stack[--stackSize];
+      const Node & node = nodes[index];
+      
+      if (p.y < node.min.y || p.y > node.max.y || p.x > node.max.x) continue;
+      
+      if (node.count > 0)
+      {
+        for (unsigned int i = node.start; i < node.start + node.count; i++)
+        {
+          const Segment & segment = segments[i];
+          if (!segment.closed || (segment.a.y > p.y) == (segment.b.y > p.y)) continue;
+          
+          if (p.x < (segment.b.x - segment.a.x) * (p.y - segment.a.y) / (segment.b.y - segment.a.y) + segment.a.x) result = !result;
+        }
+      }
+      else if (stackSize < 62)
+      {
+        stack[stackSize++] = node.start;
+        stack[stackSize++] = index + 1;
+      }
+    }
+    
+    return result;
+  }
+  
+  // Every segment within `radius` of `p`, with its closest point, in no particular order
+  void getInRadius(const glm::vec2 & p, float radius, std::vector<Nearest> & output) const
+  {
+    output.clear();
+    if (nodes.empty() || radius < 0.0f) return;
+    
+    const float radius2 = radius * radius;
+    
+    unsigned int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0)
+    {
+      const unsigned int index = stack[--stackSize];
+      const Node & node = nodes[index];
+      
+      if (getBoxDistance2(node, p) > radius2) continue;
+      
+      if (node.count > 0)
+      {
+        for (unsigned int i = node.start; i < node.start + node.count; i++)
+        {
+          float t;
+          const float distance = getSegmentDistance2(segments[i], p, t);
+          if (distance <= radius2) output.push_back({ glm::mix(segments[i].a, segments[i].b, t), sqrt(distance), segments[i].line, segments[i].index, t });
+        }
+      }
+      else if (stackSize < 62)
+      {
+        stack[stackSize++] = node.start;
+        stack[stackSize++] = index + 1;
+      }
+    }
+  }
+  
+  std::vector<Nearest> getInRadius(const glm::vec2 & p, float radius) const
+  {
+    std::vector<Nearest> output;
+    getInRadius(p, radius, output);
+    return output;
+  }
+
+#pragma mark - Intersections
+
+  // First crossing along `direction`, or a Hit with a negative distance on a miss
+  Hit raycast(const glm::vec2 & origin, const glm::vec2 & direction, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    Hit closest;
+    float limit = maxDistance;
+    
+    traverse(origin, direction, [&](const Segment & segment) {
+      Hit hit;
+      if (intersect(segment, origin, direction, limit, hit)) { closest = hit; limit = hit.distance; }
+    }, limit);
+    
+    return closest;
+  }
+  
+  // Every crossing along `direction` up to `maxDistance`, sorted from the origin outwards.
+  // Each shared vertex is reported once, collinear overlaps are not reported.
+  void getIntersections(const glm::vec2 & origin, const glm::vec2 & direction, std::vector<Hit> & output, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    output.clear();
+    
+    traverse(origin, direction, [&](const Segment & segment) {
+      Hit hit;
+      if (intersect(segment, origin, direction, maxDistance, hit)) output.push_back(hit);
+    }, maxDistance);
+    
+    std::sort(output.begin(), output.end(), [](const Hit & a, const Hit & b) { return a.distance < b.distance; });
+  }
+  
+  // Crossings of the segment from `start` to `end`, distance goes from 0 at start to 1 at end
+  void getSegmentIntersections(const glm::vec2 & start, const glm::vec2 & end, std::vector<Hit> & output) const { getIntersections(start, end - start, output, 1.0f); }
+  
+  std::vector<Hit> getSegmentIntersections(const glm::vec2 & start, const glm::vec2 & end) const
+  {
+    std::vector<Hit> output;
+    getSegmentIntersections(start, end, output);
+    return output;
+  }
+
+#pragma mark - Batch Queries
+
+  // Batch queries split over utils::Parallel's shared pool, output[i] answers points[i]
+  void getClosest(const glm::vec2 * points, size_t count, Nearest * output, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    utils::Parallel::forRange(count, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) output[i] = getClosest(points[i], maxDistance);
+    }, 64);
+  }
+  
+  void getClosest(const std::vector<glm::vec2> & points, std::vector<Nearest> & output, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    output.resize(points.size());
+    getClosest(points.data(), points.size(), output.data(), maxDistance);
+  }
+  
+  void getSignedDistance(const glm::vec2 * points, size_t count, float * output) const
+  {
+    utils::Parallel::forRange(count, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) output[i] = getSignedDistance(points[i]);
+    }, 64);
+  }
+  
+  void getSignedDistance(const std::vector<glm::vec2> & points, std::vector<float> & output) const
+  {
+    output.resize(points.size());
+    getSignedDistance(points.data(), points.size(), output.data());
+  }
+  
+  void raycast(const glm::vec2 * origins, const glm::vec2 * directions, size_t count, Hit * output, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    utils::Parallel::forRange(count, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) output[i] = raycast(origins[i], directions[i], maxDistance);
+    }, 64);
+  }
+  
+  void raycast(const std::vector<glm::vec2> & origins, const std::vector<glm::vec2> & directions, std::vector<Hit> & output, float maxDistance = std::numeric_limits<float>::max()) const
+  {
+    output.resize(MIN(origins.size(), directions.size()));
+    raycast(origins.data(), directions.data(), output.size(), output.data(), maxDistance);
+  }
+  
+  glm::vec2 getMin() const { return (nodes.empty()) ? glm::vec2(0) : nodes[0].min; }
+  glm::vec2 getMax() const { return (nodes.empty()) ? glm::vec2(0) : nodes[0].max; }
+  
+  size_t getNumSegments() const { return segments.size(); }
+  size_t getNumNodes() const { return nodes.size(); }
+  bool empty() const { return segments.empty(); }
+
+protected:
+  std::vector<Segment> segments;
+  std::vector<Node> nodes;
+  bool hasClosed { false };
+  
+  unsigned int build(std::vector<unsigned int> & order, const std::vector<glm::vec2> & centroids, size_t start, size_t end, int maxLeafSize)
+  {
+    const unsigned int nodeIndex = nodes.size();
+    nodes.push_back(Node());
+    
+    glm::vec2 min { std::numeric_limits<float>::max() };
+    glm::vec2 max { std::numeric_limits<float>::lowest() };
+    glm::vec2 centroidMin = min;
+    glm::vec2 centroidMax = max;
+    
+    for (size_t i = start; i < end; i++)
+    {
+      const Segment & segment = segments[order[i]];
+      
+      min = glm::min(min, glm::min(segment.a, segment.b));
+      max = glm::max(max, glm::max(segment.a, segment.b));
+      centroidMin = glm::min(centroidMin, centroids[order[i]]);
+      centroidMax = glm::max(centroidMax, centroids[order[i]]);
+    }
+    
+    nodes[nodeIndex].min = min;
+    nodes[nodeIndex].max = max;
+    
+    const glm::vec2 extent = centroidMax - centroidMin;
+    const int axis = (extent.x > extent.y) ? 0 : 1;
+    
+    if (end - start <= (size_t) maxLeafSize || extent[axis] <= 0.0f)
+    {
+      nodes[nodeIndex].start = start;
+      nodes[nodeIndex].count = end - start;
+      return nodeIndex;
+    }
+    
+    const size_t mid = start + (end - start) / 2;
+    std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](unsigned int a, unsigned int b) { return centroids[a][axis] < centroids[b][axis]; });
+    
+    build(order, centroids, start, mid, maxLeafSize);
+    const unsigned int right = build(order, centroids, mid, end, maxLeafSize);
+    
+    nodes[nodeIndex].start = right;
+    nodes[nodeIndex].count = 0;
+    
+    return nodeIndex;
+  }
+  
+  template<typename Func>
+  void traverse(const glm::vec2 & origin, const glm::vec2 & direction, Func && visit, const float & maxDistance) const
+  {
+    if (nodes.empty()) return;
+    
+    const glm::vec2 inverse = 1.0f / direction;
+    
+    unsigned int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0)
+    {
+      const unsigned int index = stack[--stackSize];
+      const Node & node = nodes[index];
+      
+      if (!intersectsBox(node, origin, inverse, maxDistance)) continue;
+      
+      if (node.count > 0)
+      {
+        for (unsigned int i = node.start; i < node.start + node.count; i++) visit(segments[i]);
+      }
+      else if (stackSize < 62)
+      {
+        stack[stackSize++] = node.start;
+        stack[stackSize++] = index + 1;
+      }
+    }
+  }
+  
+  static float getBoxDistance2(const Node & node, const glm::vec2 & p)
+  {
+    const glm::vec2 d = glm::max(glm::max(node.min - p, p - node.max), glm::vec2(0.0f));
+    return glm::dot(d, d);
+  }
+  
+  static float getSegmentDistance2(const Segment & segment, const glm::vec2 & p, float & t)
+  {
+    const glm::vec2 ab = segment.b - segment.a;
+    const float length2 = glm::dot(ab, ab);
+    
+    t = (length2 > 0.0f) ? CLAMP(glm::dot(p - segment.a, ab) / length2, 0.0f, 1.0f) : 0.0f;
+    
+    const glm::vec2 d = segment.a + ab * t - p;
+    return glm::dot(d, d);
+  }
+  
+  static bool intersectsBox(const Node & node, const glm::vec2 & origin, const glm::vec2 & inverse, float maxDistance)
+  {
+    float tmin = 0.0f;
+    float tmax = maxDistance;
+    
+    for (int axis = 0; axis < 2; axis++)
+    {
+      float t0 = (node.min[axis] - origin[axis]) * inverse[axis];
+      float t1 = (node.max[axis] - origin[axis]) * inverse[axis];
+      if (t0 > t1) std::swap(t0, t1);
+      
+      tmin = MAX(tmin, t0);
+      tmax = MIN(tmax, t1);
+      if (tmax < tmin) return false;
+    }
+    
+    return true;
+  }
+  
+  // Segments own their start point but not their end, except the last one of an open line,
+  // so a query through a shared vertex crosses exactly one of the two segments
+  static bool intersect(const Segment & segment, const glm::vec2 & origin, const glm::vec2 & direction, float maxDistance, Hit & hit)
+  {
+    const glm::vec2 ab = segment.b - segment.a;
+    const float denominator = direction.x * ab.y - direction.y * ab.x;
+    if (fabs(denominator) < std::numeric_limits<float>::epsilon()) return false;
+    
+    const glm::vec2 ao = segment.a - origin;
+    const float distance = (ao.x * ab.y - ao.y * ab.x) / denominator;
+    const float t = (ao.x * direction.y - ao.y * direction.x) / denominator;
+    
+    if (distance < 0.0f || distance > maxDistance) return false;
+    if (t < 0.0f || t > 1.0f || (t == 1.0f && !segment.last)) return false;
+    
+    hit = { origin + direction * distance, distance, segment.line, segment.index, t };
+    return true;
+  }
+};
+
+}}}
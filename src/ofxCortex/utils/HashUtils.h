@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace utils {
+
+// FNV-1a, for telling whether geometry changed between frames and for keying
+// caches. Pass the result of one call as the seed of the next to chain them.
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+inline uint64_t hashBytes(const void * data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+  const unsigned char * bytes = (const unsigned char *) data;
+  for (size_t i = 0; i < size; i++) { hash ^= bytes[i]; hash *= 1099511628211ull; }
+  
+  return hash;
+}
+
+// Vertex count, closed flag and vertices of the line
+inline uint64_t hashVertices(const ofPolyline & line, uint64_t hash = FNV_OFFSET_BASIS)
+{
+  const auto & vertices = line.getVertices();
+  const uint64_t header[2] = { vertices.size(), line.isClosed() };
+  hash = hashBytes(header, sizeof(header), hash);
+  if (!vertices.empty()) hash = hashBytes(vertices.data(), vertices.size() * sizeof(vertices[0]), hash);
+  
+  return hash;
+}
+
+inline uint64_t hashVertices(const std::vector<ofPolyline> & lines, uint64_t hash = FNV_OFFSET_BASIS)
+{
+  for (const auto & line : lines) hash = hashVertices(line, hash);
+  return hash;
+}
+
+}}}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace ofxCortex { namespace core { namespace utils {
+
+namespace Parallel {
+
+// Small persistent worker pool. The calling thread always takes part in
+// forRange(), so nested calls from inside a worker cannot deadlock.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t numThreads = 0)
+  {
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    
+    for (size_t i = 0; i < numThreads; i++) workers.emplace_back([this] { this->work(); });
+  }
+  
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    condition.notify_all();
+    
+    for (auto & worker : workers) worker.join();
+  }
+  
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+  
+  static ThreadPool & shared()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+  
+  // Number of threads taking part in forRange(), including the caller.
+  size_t getConcurrency() const { return workers.size() + 1; }
+  
+  void enqueue(std::function<void()> && task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+  }
+  
+  // Splits [0, count) into chunks of at least `grainSize` and calls func(begin, end)
+  // for each of them. Blocks until every chunk has been processed.
+  template<typename Func>
+  void forRange(size_t count, Func && func, size_t grainSize = 1)
+  {
+    if (count == 0) return;
+    
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t numChunks = std::min((count + grainSize - 1) / grainSize, getConcurrency() * 4);
+    
+    if (numChunks <= 1 || workers.empty())
+    {
+      func((size_t) 0, count);
+      return;
+    }
+    
+    struct State {
+      std::atomic<size_t> next { 0 };
+      std::atomic<size_t> done { 0 };
+      std::mutex mutex;
+      std::condition_variable finished;
+    };
+    
+    auto state = std::make_shared<State>();
+    const size_t chunkSize = (count + numChunks - 1) / numChunks;
+    
+    auto run = [state, chunkSize, count, numChunks, &func] {
+      size_t chunk;
+      while ((chunk = state->next++) < numChunks)
+      {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(begin + chunkSize, count);
+        if (begin < end) func(begin, end);
+        
+        if (++state->done == numChunks)
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->finished.notify_all();
+        }
+      }
+    };
+    
+    // Helpers that start late find no chunks left and return without touching `func`
+    const size_t numHelpers = std::min(workers.size(), numChunks - 1);
+    for (size_t i = 0; i < numHelpers; i++) enqueue(run);
+    
+    run();
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == numChunks; });
+  }
+  
+  // Calls func(index) for every index in [0, count).
+  template<typename Func>
+  void forEach(size_t count, Func && func, size_t grainSize = 1)
+  {
+    forRange(count, [&func](size_t begin, size_t end) { for (size_t i = begin; i < end; i++) func(i); }, grainSize);
+  }
+
+protected:
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool stopping { false };
+  
+  void work()
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+        
+        if (stopping && tasks.empty()) return;
+        
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      
+      task();
+    }
+  }
+};
+
+template<typename Func>
+inline static void forRange(size_t count, Func && func, size_t grainSize = 1) { ThreadPool::shared().forRange(count, std::forward<Func>(func), grainSize); }
+
+template<typename Func>
+inline static void forEach(size_t count, Func && func, size_t grainSize = 1) { ThreadPool::shared().forEach(count, std::forward<Func>(func), grainSize); }
+
+}
+
+}}}
@@ -3,6 +3,8 @@
 #include "ofPath.h"
 #include "ofRectangle.h"
 
+#include "ofxCortex/spatial/EdgeTable.h"
+
 namespace ofxCortex::core::utils::Path {
 
 static ofRectangle getPathBoundingBox(const ofPath & path) {
@@ -38,33 +40,46 @@ static std::vector<glm::vec3> pathIntersections(const ofPath & path, const glm::
 static std::vector<std::pair<ofRectangle, glm::ivec2>> getSlicedPath(const ofPath & path, float spacing)
 {
   ofRectangle bb = getPathBoundingBox(path);
-  bb.setFromCenter(bb.getCenter(), bb.getWidth() - 0, bb.getHeight() - 0);
   
   int rows = bb.height / spacing;
   
   std::vector<std::pair<ofRectangle, glm::ivec2>> output;
+  if (rows <= 0) return output;
+  
+  // Crossings of every row from a single sweep over the outlines, instead of testing every segment per row
+  std::vector<float> crossings;
+  std::vector<size_t> rowEnds(rows, std::numeric_limits<size_t>::max());
+  
+  spatial::ScanlineSweep(path.getOutline()).sweep(bb.y, spacing, [&](int row, float y, const std::vector<spatial::ScanlineSweep::Crossing> & active) {
+    if (row >= rows) return;
+    for (const auto & crossing : active) crossings.push_back(crossing.x);
+    rowEnds[row] = crossings.size();
+  });
+  
+  std::vector<float> rowIntersections;
+  size_t begin = 0;
   
   for (int row = 0; row < rows; row++)
   {
-    glm::vec3 start = glm::vec3(bb.getLeft(), bb.y + row * spacing, 0);
-    glm::vec3 end = glm::vec3(bb.getRight(), bb.y + row * spacing, 0);
+    if (rowEnds[row] == std::numeric_limits<size_t>::max()) rowEnds[row] = begin;
     
-    auto rowIntersections = pathIntersections(path, start, end);
-    rowIntersections.insert(rowIntersections.begin(), start);
-    rowIntersections.insert(rowIntersections.end(), end);
+    const float y = bb.y + row * spacing;
     
-    ofSort(rowIntersections, [](const glm::vec3 & a, const glm::vec3 & b) { return a.x < b.x; });
+    rowIntersections.clear();
+    rowIntersections.push_back(bb.getLeft());
+    rowIntersections.insert(rowIntersections.end(), crossings.begin() + begin, crossings.begin() + rowEnds[row]);
+    rowIntersections.push_back(bb.getRight());
     
     for (int i = 0; i < rowIntersections.size() - 1; i++)
     {
-      const glm::vec3 & current = rowIntersections[i];
-      const glm::vec3 & next = rowIntersections[i + 1];
-      
-      float width = glm::distance(current, next);
+      const float current = rowIntersections[i];
+      const float next = rowIntersections[i + 1];
       
-      ofRectangle slice { current.x, current.y, width, spacing };
+      ofRectangle slice { current, y, next - current, spacing };
       output.push_back(std::make_pair( slice, glm::ivec2(i, row) ));
     }
+    
+    begin = rowEnds[row];
   }
   
   return output;
@@ -3,6 +3,9 @@
 #include "ofPolyline.h"
 #include "ofRectangle.h"
 
+#include "ofxCortex/spatial/EdgeTable.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
 namespace ofxCortex::core::utils {
 
 class PolylineUtils {
@@ -36,30 +39,30 @@ private:
   }
 
   // signed distance from point to polygon outline (negative if point is outside)
-  static auto pointToPolygonDist(const glm::vec2& point, const ofPolyline & polygon) {
+  static auto pointToPolygonDist(const glm::vec2& point, const std::vector<ofPolyline> & polygon) {
     bool inside = false;
     auto minDistSq = std::numeric_limits<float>::infinity();
     
-  //  for (const auto& ring : polygon) {
-      for (std::size_t i = 0, len = polygon.size(), j = len - 1; i < len; j = i++) {
-        const auto& a = polygon[i];
-        const auto& b = polygon[j];
+    for (const auto& ring : polygon) {
+      for (std::size_t i = 0, len = ring.size(), j = len - 1; i < len; j = i++) {
+        const glm::vec2 a = ring[i];
+        const glm::vec2 b = ring[j];
         
         if ((a.y > point.y) != (b.y > point.y) &&
             (point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)) inside = !inside;
         
         minDistSq = std::min(minDistSq, getSegDistSq(point, a, b));
       }
-  //  }
+    }
     
     return (inside ? 1 : -1) * std::sqrt(minDistSq);
   }
 
   struct Cell {
-    Cell(const glm::vec2& c_, float h_, const ofPolyline & polygon)
+    Cell(const glm::vec2& c_, float h_, float d_)
     : c(c_),
     h(h_),
-    d(pointToPolygonDist(c, polygon)),
+    d(d_),
     max(d + h * std::sqrt(2))
     {}
     
@@ -70,7 +73,7 @@ private:
   };
 
   // get polygon centroid
-  static Cell getCentroidCell(const ofPolyline & polygon) {
+  static glm::vec2 getCentroid(const ofPolyline & polygon) {
     float area = 0;
     glm::vec2 c { 0, 0 };
     const auto& ring = polygon;
@@ -84,15 +87,57 @@ private:
       area += f * 3;
     }
     
-    return Cell(area == 0 ? ring[0] : c / area, 0, polygon);
+    return area == 0 ? glm::vec2(ring[0]) : c / area;
   }
 
 public:
   static glm::vec2 getVisualCentroid(const ofPolyline & polygon, float precision = 1, bool debug = false) {
+    return getVisualCentroid(std::vector<ofPolyline>{ polygon }, precision, debug);
+  }
+  
+  // polygon with holes: rings[0] is the outline, the other rings are holes (even-odd).
+  // Past a few dozen edges they are bucketed in a grid for the distance and in bands
+  // for the sign, so a probe only looks at the edges around it instead of all of them.
+  static glm::vec2 getVisualCentroid(const std::vector<ofPolyline> & rings, float precision = 1, bool debug = false) {
+    
+    if (rings.empty() || rings[0].size() == 0) { return glm::vec2(0); }
+    
+    std::size_t numEdges = 0;
+    for (const auto& ring : rings) numEdges += ring.size();
+    
+    if (numEdges < 96) {
+      return findVisualCentroid(rings, precision, debug, [&](const glm::vec2 & p) { return pointToPolygonDist(p, rings); });
+    }
+    
+    const spatial::EdgeGrid grid(rings);
+    const spatial::ScanlineEdgeTable table(rings);
+    
+    return findVisualCentroid(rings, precision, debug, [&](const glm::vec2 & p) { return (table.inside(p) ? 1 : -1) * grid.getDistance(p); });
+  }
+  
+  // batch versions on utils::Parallel's shared pool, output[i] is the visual centroid of polygons[i]
+  static void getVisualCentroids(const std::vector<ofPolyline> * polygons, size_t count, glm::vec2 * output, float precision = 1) {
+    Parallel::forEach(count, [&](size_t i) { output[i] = getVisualCentroid(polygons[i], precision); });
+  }
+  
+  static void getVisualCentroids(const std::vector<std::vector<ofPolyline>> & polygons, std::vector<glm::vec2> & output, float precision = 1) {
+    output.resize(polygons.size());
+    getVisualCentroids(polygons.data(), polygons.size(), output.data(), precision);
+  }
+  
+  // single-ring polygons
+  static void getVisualCentroids(const std::vector<ofPolyline> & polygons, std::vector<glm::vec2> & output, float precision = 1) {
+    output.resize(polygons.size());
+    Parallel::forEach(polygons.size(), [&](size_t i) { output[i] = getVisualCentroid(polygons[i], precision); });
+  }
+
+private:
+  // polylabel search; distance(p) is the signed distance to the outline, positive inside
+  template<typename Distance>
+  static glm::vec2 findVisualCentroid(const std::vector<ofPolyline> & rings, float precision, bool debug, Distance && distance) {
     
     // find the bounding box of the outer ring
-    //    const geometry::box<T> envelope = geometry::envelope(polygon.at(0));
-    const ofRectangle & envelope = polygon.getBoundingBox();
+    const ofRectangle & envelope = rings[0].getBoundingBox();
     
     const glm::vec2 size {
       envelope.getMax().x - envelope.getMin().x,
@@ -114,15 +159,18 @@ public:
     // cover polygon with initial cells
     for (float x = envelope.getMin().x; x < envelope.getMax().x; x += cellSize) {
       for (float y = envelope.getMin().y; y < envelope.getMax().y; y += cellSize) {
-        cellQueue.push(Cell({x + h, y + h}, h, polygon));
+        const glm::vec2 c { x + h, y + h };
+        cellQueue.push(Cell(c, h, distance(c)));
       }
     }
     
     // take centroid as the first best guess
-    auto bestCell = getCentroidCell(polygon);
+    const glm::vec2 centroid = getCentroid(rings[0]);
+    Cell bestCell(centroid, 0, distance(centroid));
     
     // second guess: bounding box centroid
-    Cell bboxCell(envelope.getMin() + size / 2.0, 0, polygon);
+    const glm::vec2 center = (glm::vec2)envelope.getMin() + size / 2.0f;
+    Cell bboxCell(center, 0, distance(center));
     if (bboxCell.d > bestCell.d) {
       bestCell = bboxCell;
     }
@@ -144,10 +192,10 @@ public:
       
       // split the cell into four cells
       h = cell.h / 2;
-      cellQueue.push(Cell({cell.c.x - h, cell.c.y - h}, h, polygon));
-      cellQueue.push(Cell({cell.c.x + h, cell.c.y - h}, h, polygon));
-      cellQueue.push(Cell({cell.c.x - h, cell.c.y + h}, h, polygon));
-      cellQueue.push(Cell({cell.c.x + h, cell.c.y + h}, h, polygon));
+      for (const glm::vec2 & offset : { glm::vec2(-h, -h), glm::vec2(h, -h), glm::vec2(-h, h), glm::vec2(h, h) }) {
+        const glm::vec2 c = cell.c + offset;
+        cellQueue.push(Cell(c, h, distance(c)));
+      }
       numProbes += 4;
     }
     
@@ -0,0 +1,686 @@
+#include "Triangulator.h"
+
+#include <deque>
+#include <numeric>
+
+#include "ofxCortex/utils/HashUtils.h"
+#include "ofxCortex/utils/ParallelUtils.h"
+
+namespace ofxCortex { namespace core { namespace utils {
+
+namespace {
+
+// Ear clipping after earcut (github.com/mapbox/earcut): holes are bridged into the
+// outline, then ears are cut off the remaining ring. When no ear is left the ring is
+// cleaned up, its small self-intersections cut, and finally it is split in two.
+class EarClipper {
+public:
+  // `points` holds x, y pairs, the outline first and then the holes, which start at `holeStarts`
+  void triangulate(const std::vector<double> & points, const std::vector<unsigned int> & holeStarts, std::vector<unsigned int> & output)
+  {
+    triangles = &output;
+    nodes.clear();
+    invSize = 0.0;
+    
+    const unsigned int numPoints = points.size() / 2;
+    const unsigned int outlineEnd = (holeStarts.empty()) ? numPoints : holeStarts[0];
+    
+    Node * outline = link(points, 0, outlineEnd, true);
+    if (!outline || outline->next == outline->prev) return;
+    
+    if (!holeStarts.empty()) outline = eliminateHoles(points, holeStarts, outline);
+    
+    // Past a few dozen points, look for points inside ears along a z-order curve
+    if (numPoints > 80)
+    {
+      double maxX = minX = points[0], maxY = minY = points[1];
+      for (unsigned int i = 1; i < outlineEnd; i++)
+      {
+        minX = MIN(minX, points[i * 2]); maxX = MAX(maxX, points[i * 2]);
+        minY = MIN(minY, points[i * 2 + 1]); maxY = MAX(maxY, points[i * 2 + 1]);
+      }
+      
+      const double size = MAX(maxX - minX, maxY - minY);
+      invSize = (size != 0.0) ? 32767.0 / size : 0.0;
+    }
+    
+    clip(outline, 0);
+  }
+
+private:
+  struct Node {
+    unsigned int i;
+    double x, y;
+    Node * prev { nullptr };
+    Node * next { nullptr };
+    int32_t z { 0 };
+    Node * prevZ { nullptr };
+    Node * nextZ { nullptr };
+    bool steiner { false };
+    
+    Node(unsigned int i, double x, double y) : i(i), x(x), y(y) {}
+  };
+  
+  std::deque<Node> nodes; // stable addresses
+  std::vector<unsigned int> * triangles { nullptr };
+  double minX { 0.0 }, minY { 0.0 }, invSize { 0.0 };
+  
+  static double area(const Node * p, const Node * q, const Node * r) { return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y); }
+  static bool equals(const Node * a, const Node * b) { return a->x == b->x && a->y == b->y; }
+  static int sign(double value) { return (value > 0.0) - (value < 0.0); }
+  
+  Node * insert(unsigned int i, double x, double y, Node * last)
+  {
+    nodes.emplace_back(i, x, y);
+    Node * p = &nodes.back();
+    
+    if (!last) { p->prev = p; p->next = p; }
+    else
+    {
+      p->next = last->next;
+      p->prev = last;
+      last->next->prev = p;
+      last->next = p;
+    }
+    return p;
+  }
+  
+  static void remove(Node * p)
+  {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+  }
+  
+  // Circular list of points [start, end) in the requested winding
+  Node * link(const std::vector<double> & points, unsigned int start, unsigned int end, bool clockwise)
+  {
+    double sum = 0.0;
+    for (unsigned int i = start, j = end - 1; i < end; j = i++) sum += (points[j * 2] - points[i * 2]) * (points[i * 2 + 1] + points[j * 2 + 1]);
+    
+    Node * last = nullptr;
+    if (clockwise == (sum > 0.0)) { for (unsigned int i = start; i < end; i++) last = insert(i, points[i * 2], points[i * 2 + 1], last); }
+    else { for (unsigned int i = end; i-- > start;) last = insert(i, points[i * 2], points[i * 2 + 1], last); }
+    
+    if (last && equals(last, last->next)) { remove(last); last = last->next; }
+    return last;
+  }
+  
+  // Drops duplicate and collinear points
+  static Node * filter(Node * start, Node * end = nullptr)
+  {
+    if (!start) return start;
+    if (!end) end = start;
+    
+    Node * p = start;
+    bool again;
+    do {
+      again = false;
+      if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+      {
+        remove(p);
+        p = end = p->prev;
+        if (p == p->next) break;
+        again = true;
+      }
+      else p = p->next;
+    } while (again || p != end);
+    
+    return end;
+  }
+  
+  void clip(Node * ear, int pass)
+  {
+    if (!ear) return;
+    if (pass == 0 && invSize != 0.0) indexCurve(ear);
+    
+    Node * stop = ear;
+    while (ear->prev != ear->next)
+    {
+      Node * prev = ear->prev;
+      Node * next = ear->next;
+      
+      if ((invSize != 0.0) ? isEarHashed(ear) : isEar(ear))
+      {
+        triangles->push_back(prev->i);
+        triangles->push_back(ear->i);
+        triangles->push_back(next->i);
+        remove(ear);
+        
+        // Skipping the next vertex leaves fewer slivers
+        ear = next->next;
+        stop = next->next;
+        continue;
+      }
+      
+      ear = next;
+      if (ear == stop)
+      {
+        if (pass == 0) clip(filter(ear), 1);
+        else if (pass == 1) clip(cureLocalIntersections(filter(ear)), 2);
+        else split(ear);
+        break;
+      }
+    }
+  }
+  
+  static bool isEar(const Node * ear)
+  {
+    const Node * a = ear->prev;
+    const Node * b = ear;
+    const Node * c = ear->next;
+    if (area(a, b, c) >= 0.0) return false; // reflex
+    
+    const double x0 = MIN(a->x, MIN(b->x, c->x)), x1 = MAX(a->x, MAX(b->x, c->x));
+    const double y0 = MIN(a->y, MIN(b->y, c->y)), y1 = MAX(a->y, MAX(b->y, c->y));
+    
+    for (const Node * p = c->next; p != a; p = p->next)
+    {
+      if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && inTriangle(a, b, c, p) && area(p->prev, p, p->next) >= 0.0) return false;
+    }
+    return true;
+  }
+  
+  bool isEarHashed(const Node * ear) const
+  {
+    const Node * a = ear->prev;
+    const Node * b = ear;
+    const Node * c = ear->next;
+    if (area(a, b, c) >= 0.0) return false; // reflex
+    
+    const double x0 = MIN(a->x, MIN(b->x, c->x)), x1 = MAX(a->x, MAX(b->x, c->x));
+    const double y0 = MIN(a->y, MIN(b->y, c->y)), y1 = MAX(a->y, MAX(b->y, c->y));
+    const int32_t minZ = getZ(x0, y0);
+    const int32_t maxZ = getZ(x1, y1);
+    
+    auto blocks = [&](const Node * p) {
+      return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c && inTriangle(a, b, c, p) && area(p->prev, p, p->next) >= 0.0;
+    };
+    
+    // Only points within the z range of the ear's bounding box can be inside it
+    const Node * p = ear->prevZ;
+    const Node * n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ)
+    {
+      if (blocks(p)) return false;
+      p = p->prevZ;
+      if (blocks(n)) return false;
+      n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ) if (blocks(p)) return false;
+    for (; n && n->z <= maxZ; n = n->nextZ) if (blocks(n)) return false;
+    
+    return true;
+  }
+  
+  static bool inTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+  {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+      (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+      (bx - px) * (cy - py) >= (cx - px) * (by - py);
+  }
+  
+  static bool inTriangle(const Node * a, const Node * b, const Node * c, const Node * p) { return inTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y); }
+  
+  Node * cureLocalIntersections(Node * start)
+  {
+    Node * p = start;
+    do {
+      Node * a = p->prev;
+      Node * b = p->next->next;
+      
+      if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+      {
+        triangles->push_back(a->i);
+        triangles->push_back(p->i);
+        triangles->push_back(b->i);
+        remove(p);
+        remove(p->next);
+        p = start = b;
+      }
+      p = p->next;
+    } while (p != start);
+    
+    return filter(p);
+  }
+  
+  // Last resort: cut the ring in two along any valid diagonal
+  void split(Node * start)
+  {
+    Node * a = start;
+    do {
+      for (Node * b = a->next->next; b != a->prev; b = b->next)
+      {
+        if (a->i != b->i && isValidDiagonal(a, b))
+        {
+          Node * c = splitPolygon(a, b);
+          a = filter(a, a->next);
+          c = filter(c, c->next);
+          clip(a, 0);
+          clip(c, 0);
+          return;
+        }
+      }
+      a = a->next;
+    } while (a != start);
+  }
+  
+  Node * eliminateHoles(const std::vector<double> & points, const std::vector<unsigned int> & holeStarts, Node * outline)
+  {
+    const unsigned int numPoints = points.size() / 2;
+    
+    std::vector<Node *> queue;
+    for (size_t h = 0; h < holeStarts.size(); h++)
+    {
+      const unsigned int end = (h + 1 < holeStarts.size()) ? holeStarts[h + 1] : numPoints;
+      if (end <= holeStarts[h]) continue;
+      
+      Node * list = link(points, holeStarts[h], end, false);
+      if (!list) continue;
+      if (list == list->next) list->steiner = true;
+      queue.push_back(getLeftmost(list));
+    }
+    
+    // Left to right, so each bridge only has to look at the holes merged before it
+    std::sort(queue.begin(), queue.end(), [](const Node * a, const Node * b) { return a->x < b->x || (a->x == b->x && a->y < b->y); });
+    
+    for (Node * hole : queue)
+    {
+      Node * bridge = findHoleBridge(hole, outline);
+      if (!bridge) continue;
+      
+      Node * bridgeReverse = splitPolygon(bridge, hole);
+      filter(bridgeReverse, bridgeReverse->next);
+      outline = filter(bridge, bridge->next);
+    }
+    
+    return outline;
+  }
+  
+  // Eberly's hole bridge: cast a ray left from the hole's leftmost point, then pick the
+  // visible outline vertex making the smallest angle with it
+  static Node * findHoleBridge(const Node * hole, Node * outline)
+  {
+    const double hx = hole->x, hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node * m = nullptr;
+    
+    Node * p = outline;
+    do {
+      if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+      {
+        const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+        if (x <= hx && x > qx)
+        {
+          qx = x;
+          m = (p->x < p->next->x) ? p : p->next;
+          if (x == hx) return m; // touches the outline
+        }
+      }
+      p = p->next;
+    } while (p != outline);
+    
+    if (!m) return nullptr;
+    
+    const Node * stop = m;
+    const double mx = m->x, my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+    
+    p = m;
+    do {
+      if (hx >= p->x && p->x >= mx && hx != p->x)
+      {
+        if (inTriangle((hy < my) ? hx : qx, hy, mx, my, (hy < my) ? qx : hx, hy, p->x, p->y))
+        {
+          const double tan = std::abs(hy - p->y) / (hx - p->x);
+          if (locallyInside(p, hole) && (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+          {
+            m = p;
+            tanMin = tan;
+          }
+        }
+      }
+      p = p->next;
+    } while (p != stop);
+    
+    return m;
+  }
+  
+  static bool sectorContainsSector(const Node * m, const Node * p) { return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0; }
+  
+  static Node * getLeftmost(Node * start)
+  {
+    Node * leftmost = start;
+    Node * p = start;
+    do {
+      if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) leftmost = p;
+      p = p->next;
+    } while (p != start);
+    return leftmost;
+  }
+  
+  int32_t getZ(double x, double y) const
+  {
+    uint32_t ix = (uint32_t) ((x - minX) * invSize);
+    uint32_t iy = (uint32_t) ((y - minY) * invSize);
+    
+    ix = (ix | (ix << 8)) & 0x00FF00FF; ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+    ix = (ix | (ix << 2)) & 0x33333333; ix = (ix | (ix << 1)) & 0x55555555;
+    iy = (iy | (iy << 8)) & 0x00FF00FF; iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+    iy = (iy | (iy << 2)) & 0x33333333; iy = (iy | (iy << 1)) & 0x55555555;
+    
+    return (int32_t) (ix | (iy << 1));
+  }
+  
+  // Links the nodes along the z-order curve with a linked list merge sort
+  void indexCurve(Node * start)
+  {
+    Node * p = start;
+    do {
+      if (p->z == 0) p->z = getZ(p->x, p->y);
+      p->prevZ = p->prev;
+      p->nextZ = p->next;
+      p = p->next;
+    } while (p != start);
+    
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+    
+    Node * list = p;
+    int inSize = 1;
+    int numMerges;
+    do {
+      Node * q;
+      Node * tail = nullptr;
+      p = list;
+      list = nullptr;
+      numMerges = 0;
+      
+      while (p)
+      {
+        numMerges++;
+        q = p;
+        int pSize = 0;
+        for (int i = 0; i < inSize && q; i++) { pSize++; q = q->nextZ; }
+        int qSize = inSize;
+        
+        while (pSize > 0 || (qSize > 0 && q))
+        {
+          Node * e;
+          if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) { e = p; p = p->nextZ; pSize--; }
+          else { e = q; q = q->nextZ; qSize--; }
+          
+          if (tail) tail->nextZ = e;
+          else list = e;
+          e->prevZ = tail;
+          tail = e;
+        }
+        p = q;
+      }
+      
+      tail->nextZ = nullptr;
+      inSize *= 2;
+    } while (numMerges > 1);
+  }
+  
+  static bool isValidDiagonal(const Node * a, const Node * b)
+  {
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+      ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) && (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0)) ||
+       (equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+  }
+  
+  static bool onSegment(const Node * p, const Node * q, const Node * r)
+  {
+    return q->x <= MAX(p->x, r->x) && q->x >= MIN(p->x, r->x) && q->y <= MAX(p->y, r->y) && q->y >= MIN(p->y, r->y);
+  }
+  
+  static bool intersects(const Node * p1, const Node * q1, const Node * p2, const Node * q2)
+  {
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+    
+    if (o1 != o2 && o3 != o4) return true;
+    if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+    if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+    if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+    if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+    return false;
+  }
+  
+  static bool intersectsPolygon(const Node * a, const Node * b)
+  {
+    const Node * p = a;
+    do {
+      if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b)) return true;
+      p = p->next;
+    } while (p != a);
+    return false;
+  }
+  
+  static bool locallyInside(const Node * a, const Node * b)
+  {
+    return (area(a->prev, a, a->next) < 0.0) ?
+      area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0 :
+      area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+  }
+  
+  static bool middleInside(const Node * a, const Node * b)
+  {
+    const double px = (a->x + b->x) * 0.5, py = (a->y + b->y) * 0.5;
+    bool inside = false;
+    
+    const Node * p = a;
+    do {
+      if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y && (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) inside = !inside;
+      p = p->next;
+    } while (p != a);
+    return inside;
+  }
+  
+  // Joins a and b with a two-way bridge: splits a ring in two, or merges a hole into its outline
+  Node * splitPolygon(Node * a, Node * b)
+  {
+    nodes.emplace_back(a->i, a->x, a->y);
+    Node * a2 = &nodes.back();
+    nodes.emplace_back(b->i, b->x, b->y);
+    Node * b2 = &nodes.back();
+    
+    Node * an = a->next;
+    Node * bp = b->prev;
+    
+    a->next = b; b->prev = a;
+    a2->next = an; an->prev = a2;
+    b2->next = a2; a2->prev = b2;
+    bp->next = b2; b2->prev = bp;
+    
+    return b2;
+  }
+};
+
+// Even-odd test against a ring taken as closed
+bool inside(const ofPolyline & ring, const glm::vec2 & p)
+{
+  const auto & vertices = ring.getVertices();
+  bool result = false;
+  
+  for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+  {
+    const glm::vec2 a = vertices[i], b = vertices[j];
+    if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) result = !result;
+  }
+  return result;
+}
+
+double getArea(const ofPolyline & ring)
+{
+  const auto & vertices = ring.getVertices();
+  double area = 0.0;
+  for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) area += (double) vertices[j].x * vertices[i].y - (double) vertices[i].x * vertices[j].y;
+  return area * 0.5;
+}
+
+void append(const std::vector<ofPolyline> & shape, ofMesh & output)
+{
+  if (shape.empty()) return;
+  
+  const std::vector<ofPolyline> holes(shape.begin() + 1, shape.end());
+  const std::vector<unsigned int> triangles = Triangulator::triangulate(shape.front(), holes);
+  if (triangles.empty()) return;
+  
+  auto & vertices = output.getVertices();
+  auto & indices = output.getIndices();
+  const ofIndexType offset = vertices.size();
+  
+  for (const auto & ring : shape)
+  {
+    for (const auto & vertex : ring.getVertices()) vertices.emplace_back(vertex.x, vertex.y, 0.0f);
+  }
+  
+  indices.reserve(indices.size() + triangles.size());
+  for (unsigned int index : triangles) indices.push_back(offset + index);
+}
+
+}
+
+bool Triangulator::update(const std::vector<ofPolyline> & rings)
+{
+  const uint64_t newHash = getHash(rings);
+  if (newHash == hash && hash != 0) return false;
+  
+  hash = newHash;
+  mesh.clear();
+  build(rings, mesh);
+  
+  return true;
+}
+
+void Triangulator::build(const std::vector<ofPolyline> & rings, ofMesh & output)
+{
+  output.setMode(OF_PRIMITIVE_TRIANGLES);
+  
+  if (rings.size() == 1) append(rings, output);
+  else for (const auto & shape : getShapes(rings)) append(shape, output);
+}
+
+ofMesh Triangulator::getMesh(const std::vector<ofPolyline> & rings)
+{
+  ofMesh mesh;
+  build(rings, mesh);
+  return mesh;
+}
+
+void Triangulator::build(const std::vector<ofPolyline> * shapes, size_t count, ofMesh * output)
+{
+  Parallel::forEach(count, [&](size_t i) {
+    output[i].clear();
+    build(shapes[i], output[i]);
+  });
+}
+
+void Triangulator::build(const std::vector<std::vector<ofPolyline>> & shapes, std::vector<ofMesh> & output)
+{
+  output.resize(shapes.size());
+  build(shapes.data(), shapes.size(), output.data());
+}
+
+void Triangulator::build(const std::vector<ofPath> & paths, std::vector<ofMesh> & output)
+{
+  output.resize(paths.size());
+  Parallel::forEach(paths.size(), [&](size_t i) {
+    output[i].clear();
+    build(paths[i].getOutline(), output[i]);
+  });
+}
+
+std::vector<unsigned int> Triangulator::triangulate(const ofPolyline & outline, const std::vector<ofPolyline> & holes)
+{
+  std::vector<double> points;
+  std::vector<unsigned int> holeStarts;
+  
+  size_t numPoints = outline.size();
+  for (const auto & hole : holes) numPoints += hole.size();
+  points.reserve(numPoints * 2);
+  
+  auto add = [&points](const ofPolyline & ring) {
+    for (const auto & vertex : ring.getVertices()) { points.push_back(vertex.x); points.push_back(vertex.y); }
+  };
+  
+  add(outline);
+  for (const auto & hole : holes)
+  {
+    holeStarts.push_back(points.size() / 2);
+    add(hole);
+  }
+  
+  std::vector<unsigned int> triangles;
+  if (outline.size() < 3) return triangles;
+  
+  triangles.reserve((numPoints + holes.size() * 2) * 3);
+  
+  EarClipper clipper;
+  clipper.triangulate(points, holeStarts, triangles);
+  return triangles;
+}
+
+std::vector<std::vector<ofPolyline>> Triangulator::getShapes(const std::vector<ofPolyline> & rings)
+{
+  struct Ring {
+    size_t index;
+    double area;
+    ofRectangle bounds;
+  };
+  
+  std::vector<Ring> sorted;
+  sorted.reserve(rings.size());
+  for (size_t i = 0; i < rings.size(); i++)
+  {
+    if (rings[i].size() < 3) continue;
+    sorted.push_back({ i, std::abs(getArea(rings[i])), rings[i].getBoundingBox() });
+  }
+  
+  // Largest first, so every ring that can contain another comes before it
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Ring & a, const Ring & b) { return a.area > b.area; });
+  
+  std::vector<std::vector<ofPolyline>> shapes;
+  std::vector<int> shapeOf(sorted.size(), -1);
+  
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    const glm::vec2 p = rings[sorted[i].index][0];
+    
+    // Rings do not cross, so the containing rings are nested and the last one found is the parent
+    int depth = 0;
+    int parent = -1;
+    for (size_t j = 0; j < i; j++)
+    {
+      if (!sorted[j].bounds.inside(p) || !inside(rings[sorted[j].index], p)) continue;
+      depth++;
+      parent = j;
+    }
+    
+    if (depth % 2 == 0)
+    {
+      shapeOf[i] = shapes.size();
+      shapes.push_back({ rings[sorted[i].index] });
+    }
+    else
+    {
+      shapeOf[i] = shapeOf[parent];
+      shapes[shapeOf[i]].push_back(rings[sorted[i].index]);
+    }
+  }
+  
+  return shapes;
+}
+
+uint64_t Triangulator::getHash(const std::vector<ofPolyline> & rings)
+{
+  const uint64_t hash = hashVertices(rings);
+  return (hash == 0) ? 1 : hash;
+}
+
+}}}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ofMesh.h"
+#include "ofPath.h"
+#include "ofPolyline.h"
+
+namespace ofxCortex { namespace core { namespace utils {
+
+// Fills polygons with holes on the CPU, without the GLU tessellator behind
+// ofPath. Ear clipping over a linked list of the vertices, where large
+// polygons keep their vertices sorted along a z-order curve so finding the
+// points inside a candidate ear only looks at its neighbourhood. Holes are
+// bridged into the outline first, so holes and outlines are both handled by
+// the same ear loop.
+//
+// Rings can come in any order and winding (ofPath outlines, Clipper results,
+// Typography glyphs): they are grouped by nesting with the even-odd rule, so
+// a ring inside one outline is a hole and a ring inside that hole is a new
+// outline. Rings should not cross each other.
+//
+// Use the static build() for one-off meshes, or keep a Triangulator around and
+// call update() every frame: the mesh is only rebuilt when the input changed.
+class Triangulator {
+public:
+  Triangulator() {};
+  
+  // Returns true when the mesh had to be rebuilt
+  bool update(const std::vector<ofPolyline> & rings);
+  bool update(const ofPolyline & ring) { return update(std::vector<ofPolyline>{ ring }); }
+  bool update(const ofPath & path) { return update(path.getOutline()); }
+  
+  const ofMesh & getMesh() const { return mesh; }
+  void draw() const { mesh.draw(); }
+  
+  // Appends the triangles of `rings` to `output` (OF_PRIMITIVE_TRIANGLES, indexed, z = 0)
+  static void build(const std::vector<ofPolyline> & rings, ofMesh & output);
+  static void build(const ofPolyline & ring, ofMesh & output) { build(std::vector<ofPolyline>{ ring }, output); }
+  static void build(const ofPath & path, ofMesh & output) { build(path.getOutline(), output); }
+  
+  static ofMesh getMesh(const std::vector<ofPolyline> & rings);
+  static ofMesh getMesh(const ofPath & path) { return getMesh(path.getOutline()); }
+  
+  // One mesh per shape, shapes are triangulated in parallel. `output` is cleared first.
+  static void build(const std::vector<ofPolyline> * shapes, size_t count, ofMesh * output);
+  static void build(const std::vector<std::vector<ofPolyline>> & shapes, std::vector<ofMesh> & output);
+  static void build(const std::vector<ofPath> & paths, std::vector<ofMesh> & output);
+  
+  // Indices into the concatenated vertices of `outline` and then `holes`, three per triangle.
+  // The rings are taken as they are, without checking which one contains which.
+  static std::vector<unsigned int> triangulate(const ofPolyline & outline, const std::vector<ofPolyline> & holes = {});
+  
+  // Groups rings into outlines and their holes with the even-odd rule: each entry is
+  // an outline followed by its holes
+  static std::vector<std::vector<ofPolyline>> getShapes(const std::vector<ofPolyline> & rings);
+
+protected:
+  ofMesh mesh;
+  uint64_t hash { 0 };
+  
+  static uint64_t getHash(const std::vector<ofPolyline> & rings);
+};
+
+}}}